@@ -6,7 +6,7 @@
 
 QMAKE_CXXFLAGS = -Wno-unused-parameter -Wno-attributes
 
-QT       += sql core gui network testlib
+QT       += sql core gui network testlib concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -34,20 +34,25 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 CONFIG += c++11
 
+# the benchmark and the dataset generator are built by benchmark/benchmark.pro
+include(core.pri)
+
 SOURCES += \
         EqualizerDialog.cpp \
 #        downloadmanager.cpp \
         main.cpp \
         mainwindow.cpp \
-        dbmanager.cpp \
-        filedownloader.cpp
+        filedownloader.cpp \
+        headlessrunner.cpp \
+        epgcache.cpp
 
 HEADERS += \
         EqualizerDialog.h \
  #       downloadmanager.h \
         mainwindow.h \
-        dbmanager.h \
-        filedownloader.h
+        filedownloader.h \
+        headlessrunner.h \
+        epgcache.h
 
 FORMS += \
         EqualizerDialog.ui \
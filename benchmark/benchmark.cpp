@@ -0,0 +1,381 @@
+#include "benchmark.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTreeWidget>
+#include <QVariant>
+#include <QtConcurrent>
+
+#include "dbmanager.h"
+#include "importworker.h"
+#include "m3uexporter.h"
+#include "m3uparser.h"
+#include "stationtree.h"
+#include "datasetgenerator.h"
+
+static const int groups = 50;
+
+// the tokenizer of the import before M3uParser::parseAttributes(), kept as
+// reference for the extinf_tokenize_legacy result
+static QStringList splitCommandLine(const QString & cmdLine)
+{
+    QStringList list;
+    QString arg;
+
+    bool escape = false;
+    enum { Idle, Arg, QuotedArg } state = Idle;
+
+    foreach (QChar const c, cmdLine) {
+        if (!escape && c == '\\') { escape = true; continue; }
+        switch (state) {
+        case Idle:
+            if (!escape && c == '"') state = QuotedArg;
+            else if (escape || !c.isSpace()) { arg += c; state = Arg; }
+            break;
+        case Arg:
+            if (!escape && c == '"') state = QuotedArg;
+            else if (escape || !c.isSpace()) arg += c;
+            else { list << arg; arg.clear(); state = Idle; }
+            break;
+        case QuotedArg:
+            if (!escape && c == '"') state = arg.isEmpty() ? Idle : Arg;
+            else arg += c;
+            break;
+        }
+        escape = false;
+    }
+    if (!arg.isEmpty()) list << arg;
+    return list;
+}
+
+Benchmark::Benchmark(const QList<int> &sizes, QObject *parent) :
+    QObject(parent),
+    m_sizes(sizes),
+    m_count(0)
+{
+}
+
+bool Benchmark::run(const QString &jsonFile)
+{
+    if ( ! m_dir.isValid() ) {
+        qDebug() << "Benchmark" << "no temporary directory";
+        return false;
+    }
+
+    this->benchmarkTokenizer();
+
+    foreach (int entries, m_sizes) {
+        this->benchmarkM3uImport(entries);
+    }
+
+    this->benchmarkEpgImport();
+
+    QJsonObject root;
+    root.insert("application", "m3uMan");
+    root.insert("qt", QString(qVersion()));
+    root.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("results", m_results);
+
+    QFile file(jsonFile);
+
+    if ( ! file.open(QIODevice::WriteOnly) ) {
+        qDebug() << "Benchmark" << "couldn't write" << jsonFile;
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+
+    return true;
+}
+
+void Benchmark::addResult(const QString &name, int entries, qint64 msecs)
+{
+    QJsonObject result;
+
+    result.insert("name", name);
+    result.insert("entries", entries);
+    result.insert("msecs", double(msecs));
+    result.insert("perSecond", msecs > 0 ? entries * 1000.0 / msecs : 0.0);
+
+    m_results.append(result);
+
+    qDebug() << "Benchmark" << name << entries << "entries in" << msecs << "ms";
+}
+
+void Benchmark::m3uImportFinished(int stations, int, int, int, int, int, double, bool, bool)
+{
+    m_count = stations;
+}
+
+void Benchmark::epgImportFinished(int programs, int, double, const QString &error, bool)
+{
+    if ( ! error.isEmpty() ) {
+        qDebug() << "Benchmark" << error;
+    }
+
+    m_count = programs;
+}
+
+void Benchmark::benchmarkTokenizer()
+{
+    const int lines = 10000;
+    const int rounds = 100;
+
+    QList<QByteArray> tags;
+    M3uAttributes     attributes;
+    QElapsedTimer     timer;
+    int               found = 0;
+
+    for ( int i = 0; i < lines; i++ ) {
+        tags << QString("#EXTINF:-1 tvg-id=\"station%1.de\" tvg-name=\"Station %1, HD\" tvg-logo=\"http://logo.example.com/%1.png\" "
+                        "group-title=\"Group %2\" tvg-chno=\"%1\" catchup=\"default\"").arg(i).arg(i % groups).toUtf8();
+    }
+
+    timer.start();
+
+    for ( int round = 0; round < rounds; round++ ) {
+        foreach (const QByteArray &line, tags) {
+            M3uParser::parseAttributes(M3uField(line.constData(), line.size()), attributes);
+            found += attributes.tvgChno.size;
+        }
+    }
+
+    this->addResult("extinf_tokenize", lines * rounds, timer.elapsed());
+
+    // the same lines through the old split and contains() path
+    timer.start();
+
+    for ( int round = 0; round < rounds; round++ ) {
+        foreach (const QByteArray &line, tags) {
+
+            QString tvg_chno = "0";
+
+            foreach(QString item, splitCommandLine(QString::fromUtf8(line))) {
+
+                if ( item.contains("tvg-name") ) {
+                    found += item.split("=").at(1).size();
+                }
+                else if ( item.contains("tvg-id") ) {
+                    found += item.split("=").at(1).size();
+                }
+                else if ( item.contains("group-title") ) {
+                    found += item.split("=").at(1).size();
+                }
+                else if ( item.contains("tvg-logo") ) {
+                    found += item.split("=").at(1).size();
+                }
+                else if ( item.contains("tvg-chno") ) {
+                    tvg_chno = item.split("=").at(1);
+                }
+            }
+
+            found += tvg_chno.toInt();
+        }
+    }
+
+    this->addResult("extinf_tokenize_legacy", lines * rounds, timer.elapsed());
+
+    Q_UNUSED(found)
+}
+
+void Benchmark::benchmarkM3uImport(int entries)
+{
+    const QString m3uFile = m_dir.filePath(QString("bench-%1.m3u").arg(entries));
+    const QString dbFile = m_dir.filePath(QString("bench-%1.sqlite").arg(entries));
+    const QString unsafeDbFile = m_dir.filePath(QString("bench-%1-unsafe.sqlite").arg(entries));
+    const QString exportFile = m_dir.filePath(QString("bench-%1-export.m3u").arg(entries));
+
+    QElapsedTimer    timer;
+    DatasetGenerator generator;
+
+    generator.setGroups(groups);
+    generator.setChannels(entries);
+
+    if ( ! generator.writeM3u(m3uFile) ) {
+        return;
+    }
+
+    // ------------------------------------------------
+    // first import into an empty database, then again unchanged
+    // ------------------------------------------------
+    {
+        ImportWorker worker(dbFile);
+
+        connect(&worker, SIGNAL(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)), this, SLOT(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)));
+
+        timer.start();
+        worker.importM3u(m3uFile);
+        this->addResult("m3u_import", m_count, timer.elapsed());
+
+        timer.start();
+        worker.importM3u(m3uFile);
+        this->addResult("m3u_reimport", m_count, timer.elapsed());
+    }
+
+    // ------------------------------------------------
+    // the same with the old journal_mode MEMORY / synchronous OFF
+    // ------------------------------------------------
+    {
+        ImportWorker worker(unsafeDbFile);
+
+        worker.setJournal(DbManager::JournalMemory);
+
+        connect(&worker, SIGNAL(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)), this, SLOT(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)));
+
+        timer.start();
+        worker.importM3u(m3uFile);
+        this->addResult("m3u_import_unsafe", m_count, timer.elapsed());
+
+        timer.start();
+        worker.importM3u(m3uFile);
+        this->addResult("m3u_reimport_unsafe", m_count, timer.elapsed());
+    }
+
+    this->benchmarkConcurrentReads(entries, m3uFile, dbFile);
+
+    DbManager db;
+
+    if ( ! db.open(dbFile, "benchmark") ) {
+        return;
+    }
+
+    // ------------------------------------------------
+    // the station tree, filled by the same code as MainWindow::fillTreeWidget
+    // ------------------------------------------------
+    {
+        QTreeWidget            tree;
+        std::vector<ExtinfRow> stations;
+
+        timer.start();
+
+        db.selectEXTINF("", "", "0", 0, stations);
+
+        StationTree(&tree).populate(stations);
+
+        this->addResult("tree_populate", int(stations.size()), timer.elapsed());
+    }
+
+    // ------------------------------------------------
+    // station search as typed into the filter of the tree
+    // ------------------------------------------------
+    {
+        const int              searches = 100;
+        std::vector<ExtinfRow> stations;
+
+        timer.start();
+
+        for ( int i = 0; i < searches; i++ ) {
+            db.selectEXTINF("", "%" + generator.channelName(i * ( entries / searches )) + "%", "0", 0, stations);
+        }
+
+        this->addResult("station_search", searches, timer.elapsed());
+    }
+
+    // ------------------------------------------------
+    // export of the first group playlist as MainWindow::MakePlaylist does
+    // it, with the stations in the order of the playlist items
+    // ------------------------------------------------
+    {
+        M3uExporter             exporter(db);
+        std::vector<PlsItemRow> items;
+        QList<int>              extinf_ids;
+        int                     pls_id = 0;
+
+        DbCursor select = db.selectPLS_by_pls_name(generator.groupTitle(0));
+        if ( select->next() ) {
+            pls_id = select->value(0).toInt();
+        }
+
+        db.selectPLS_Items(pls_id, "%%", 0, items);
+
+        for ( const PlsItemRow &item : items ) {
+            extinf_ids << item.extinf_id;
+        }
+
+        timer.start();
+        exporter.exportStations(extinf_ids, generator.groupTitle(0), exportFile);
+        this->addResult("m3u_export", exporter.entries(), timer.elapsed());
+    }
+}
+
+// reimports on a pool thread while this thread keeps reading the station
+// list on a connection of its own, as the gui does during an import
+void Benchmark::benchmarkConcurrentReads(int entries, const QString &m3uFile, const QString &dbFile)
+{
+    QElapsedTimer          timer;
+    DbManager              db;
+    std::vector<ExtinfRow> stations;
+    int                    reads = 0;
+    int                    rows = 0;
+
+    if ( ! db.open(dbFile, "benchmark-reader") ) {
+        return;
+    }
+
+    timer.start();
+
+    QFuture<void> import = QtConcurrent::run([&dbFile, &m3uFile]() {
+        ImportWorker worker(dbFile);
+        worker.importM3u(m3uFile);
+    });
+
+    while ( ! import.isFinished() ) {
+        db.selectEXTINF("", "", "0", 0, stations);
+        rows += int(stations.size());
+        reads++;
+    }
+
+    import.waitForFinished();
+
+    this->addResult("m3u_reimport_with_reads", entries, timer.elapsed());
+    this->addResult("tree_reads_during_import", rows, timer.elapsed());
+
+    qDebug() << "Benchmark" << reads << "station list reads during the import";
+}
+
+void Benchmark::benchmarkEpgImport()
+{
+    const QString xmlFile = m_dir.filePath("bench-epg.xml");
+    const QString dbFile = m_dir.filePath("bench-epg.sqlite");
+    const QString unsafeDbFile = m_dir.filePath("bench-epg-unsafe.sqlite");
+
+    QElapsedTimer    timer;
+    DatasetGenerator generator;
+
+    generator.setChannels(200);
+    generator.setEpgDays(7);
+    generator.setEpgStart(QDate::currentDate());
+
+    if ( ! generator.writeXmltv(xmlFile) ) {
+        return;
+    }
+
+    {
+        ImportWorker worker(dbFile);
+
+        connect(&worker, SIGNAL(epgImportFinished(int,int,double,QString,bool)), this, SLOT(epgImportFinished(int,int,double,QString,bool)));
+
+        timer.start();
+        worker.importEpg(xmlFile, "0");
+        this->addResult("xmltv_import", m_count, timer.elapsed());
+    }
+
+    {
+        ImportWorker worker(unsafeDbFile);
+
+        worker.setJournal(DbManager::JournalMemory);
+
+        connect(&worker, SIGNAL(epgImportFinished(int,int,double,QString,bool)), this, SLOT(epgImportFinished(int,int,double,QString,bool)));
+
+        timer.start();
+        worker.importEpg(xmlFile, "0");
+        this->addResult("xmltv_import_unsafe", m_count, timer.elapsed());
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QObject>
+#include <QJsonArray>
+#include <QTemporaryDir>
+
+// Times the import, EPG and export hot paths on synthetic data in a
+// temporary SQLite file and writes the results as JSON, so runs of
+// different releases can be compared. Needs a QApplication for the tree.
+// The imports run a second time with the old unsafe journal settings, the
+// *_unsafe results are the reference for the WAL journal.
+
+class Benchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Benchmark(const QList<int> &sizes, QObject *parent = nullptr);
+
+    bool run(const QString &jsonFile);
+
+private slots:
+    void m3uImportFinished(int, int, int, int, int, int, double, bool, bool);
+    void epgImportFinished(int, int, double, const QString &, bool);
+
+private:
+    void benchmarkTokenizer();
+    void benchmarkM3uImport(int entries);
+    void benchmarkConcurrentReads(int entries, const QString &m3uFile, const QString &dbFile);
+    void benchmarkEpgImport();
+
+    void addResult(const QString &name, int entries, qint64 msecs);
+
+    QList<int>    m_sizes;
+    QTemporaryDir m_dir;
+    QJsonArray    m_results;
+    int           m_count;
+};
+
+#endif // BENCHMARK_H
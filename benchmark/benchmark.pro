@@ -0,0 +1,25 @@
+# Benchmark and synthetic dataset generator, kept out of the application.
+#
+#   qmake benchmark/benchmark.pro && make
+#   ./QtM3uManBenchmark --benchmark results.json
+
+QT       += core gui widgets
+
+TARGET = QtM3uManBenchmark
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../core.pri)
+
+SOURCES += \
+        main.cpp \
+        benchmark.cpp \
+        datasetgenerator.cpp
+
+HEADERS += \
+        benchmark.h \
+        datasetgenerator.h
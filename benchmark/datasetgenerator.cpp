@@ -0,0 +1,245 @@
+#include "datasetgenerator.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+
+static const char *countries[] = { "DE", "AT", "CH", "UK", "FR", "IT", "ES", "NL", "PL", "TR" };
+static const char *categories[] = { "NEWS", "SPORT", "MOVIES", "KIDS", "MUSIC", "DOKU", "RADIO", "HD", "4K", "VOD" };
+static const char *words[] = { "Das Erste", "Welt", "Sport", "Kino", "Musik", "Nachrichten", "Kinder", "Natur",
+                               "Geschichte", "Planet", "Fußball", "Café", "Österreich", "Série", "Ciné" };
+static const char *titles[] = { "Tagesschau", "Der Tatort", "Sportschau", "Wetter", "Dokumentation", "Spielfilm",
+                                "Nachrichten", "Quiz & Show", "Serie <Staffel 2>", "Magazin" };
+
+#define COUNT(list) int(sizeof(list) / sizeof(list[0]))
+
+DatasetGenerator::DatasetGenerator(quint64 seed) :
+    m_seed(seed),
+    m_state(seed),
+    m_groups(50),
+    m_channels(10000),
+    m_epgDays(7),
+    m_epgStart(2020, 1, 1),
+    m_urlPattern("http://stream.example.com/live/%1/%2.ts"),
+    m_logoPattern("http://logo.example.com/%1.png")
+{
+}
+
+void DatasetGenerator::setGroups(int groups)
+{
+    m_groups = qMax(1, groups);
+}
+
+void DatasetGenerator::setChannels(int channels)
+{
+    m_channels = qMax(0, channels);
+}
+
+void DatasetGenerator::setEpgDays(int days)
+{
+    m_epgDays = qMax(0, days);
+}
+
+void DatasetGenerator::setEpgStart(const QDate &date)
+{
+    if ( date.isValid() ) {
+        m_epgStart = date;
+    }
+}
+
+void DatasetGenerator::setUrlPattern(const QString &pattern)
+{
+    m_urlPattern = pattern;
+}
+
+void DatasetGenerator::setLogoPattern(const QString &pattern)
+{
+    m_logoPattern = pattern;
+}
+
+quint64 DatasetGenerator::random()
+{
+    // splitmix64, the same sequence on every platform and Qt version
+    quint64 z = ( m_state += Q_UINT64_C(0x9E3779B97F4A7C15) );
+
+    z = ( z ^ ( z >> 30 ) ) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+    z = ( z ^ ( z >> 27 ) ) * Q_UINT64_C(0x94D049BB133111EB);
+
+    return z ^ ( z >> 31 );
+}
+
+int DatasetGenerator::random(int bound)
+{
+    return bound > 0 ? int(this->random() % quint64(bound)) : 0;
+}
+
+bool DatasetGenerator::chance(int percent)
+{
+    return this->random(100) < percent;
+}
+
+QString DatasetGenerator::groupTitle(int group) const
+{
+    const int country = group % COUNT(countries);
+    const int category = ( group / COUNT(countries) ) % COUNT(categories);
+    const int round = group / ( COUNT(countries) * COUNT(categories) );
+
+    QString title = QString("%1 | %2").arg(countries[country]).arg(categories[category]);
+
+    if ( round > 0 ) {
+        title += QString(" %1").arg(round + 1);
+    }
+
+    return title;
+}
+
+QString DatasetGenerator::channelName(int channel) const
+{
+    return QString("%1| %2 %3").arg(countries[channel % COUNT(countries)])
+                               .arg(words[( channel / COUNT(countries) ) % COUNT(words)])
+                               .arg(channel);
+}
+
+QString DatasetGenerator::channelId(int channel) const
+{
+    return QString("channel%1.%2").arg(channel).arg(QString(countries[channel % COUNT(countries)]).toLower());
+}
+
+bool DatasetGenerator::writeM3u(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if ( ! file.open(QIODevice::WriteOnly) ) {
+        qDebug() << "DatasetGenerator" << "couldn't write" << fileName;
+        return false;
+    }
+
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+
+    m_state = m_seed;
+
+    out << "#EXTM3U\n";
+
+    for ( int channel = 0; channel < m_channels; channel++ ) {
+
+        const int group = this->random(m_groups);
+        QString   name = this->channelName(channel);
+        QString   url = m_urlPattern.arg(group).arg(channel);
+        QString   attributes = QString("tvg-chno=\"%1\"").arg(channel + 1);
+
+        // 2% duplicate urls, pointing back to an earlier channel
+        if ( channel > 0 && this->chance(2) ) {
+            const int other = this->random(channel);
+            url = m_urlPattern.arg(other % m_groups).arg(other);
+        }
+
+        // commas, apostrophes and ampersands inside of names
+        if ( this->chance(5) ) {
+            name += ", HD";
+        } else if ( this->chance(1) ) {
+            name += "'s Kids & Family";
+        }
+
+        // every attribute may be missing
+        if ( ! this->chance(3) ) {
+            attributes += QString(" tvg-name=\"%1\"").arg(name);
+        }
+        if ( ! this->chance(20) ) {
+            attributes += QString(" tvg-id=\"%1\"").arg(this->channelId(channel));
+        }
+        if ( ! this->chance(2) ) {
+            attributes += QString(" group-title=\"%1\"").arg(this->groupTitle(group));
+        }
+        if ( ! this->chance(10) ) {
+            attributes += QString(" tvg-logo=\"%1\"").arg(m_logoPattern.arg(channel));
+        }
+        if ( this->chance(10) ) {
+            attributes += " catchup=default catchup-days=7";
+        }
+
+        out << "#EXTINF:-1 " << attributes << "," << name << "\n";
+
+        if ( this->chance(5) ) {
+            out << "#EXTVLCOPT:http-user-agent=m3uMan\n";
+        }
+
+        out << url << "\n";
+    }
+
+    file.close();
+
+    return file.error() == QFile::NoError;
+}
+
+bool DatasetGenerator::writeXmltv(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if ( ! file.open(QIODevice::WriteOnly) ) {
+        qDebug() << "DatasetGenerator" << "couldn't write" << fileName;
+        return false;
+    }
+
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+
+    const QDateTime begin(m_epgStart, QTime(0, 0), Qt::UTC);
+    const QDateTime end = begin.addDays(m_epgDays);
+
+    m_state = m_seed ^ Q_UINT64_C(0x5851F42D4C957F2D);
+
+    xml.writeStartDocument();
+    xml.writeStartElement("tv");
+    xml.writeAttribute("generator-info-name", "m3uMan DatasetGenerator");
+
+    for ( int channel = 0; channel < m_channels; channel++ ) {
+        xml.writeStartElement("channel");
+        xml.writeAttribute("id", this->channelId(channel));
+        xml.writeTextElement("display-name", this->channelName(channel));
+        xml.writeEndElement();
+    }
+
+    for ( int channel = 0; channel < m_channels; channel++ ) {
+
+        const QString id = this->channelId(channel);
+        QDateTime start = begin;
+
+        while ( start < end ) {
+
+            // 15 minutes up to 3 hours, some of them run across midnight
+            const QDateTime stop = start.addSecs(( 1 + this->random(12) ) * 15 * 60);
+            const int title = this->random(COUNT(titles));
+
+            xml.writeStartElement("programme");
+            xml.writeAttribute("start", start.toString("yyyyMMddhhmmss") + " +0000");
+            xml.writeAttribute("stop", stop.toString("yyyyMMddhhmmss") + " +0000");
+            xml.writeAttribute("channel", id);
+
+            xml.writeStartElement("title");
+            xml.writeAttribute("lang", "de");
+            xml.writeCharacters(titles[title]);
+            xml.writeEndElement();
+
+            if ( ! this->chance(10) ) {
+                xml.writeStartElement("desc");
+                xml.writeAttribute("lang", "de");
+                xml.writeCharacters(QString("%1 on %2, episode %3.").arg(titles[title]).arg(this->channelName(channel)).arg(this->random(500)));
+                xml.writeEndElement();
+            }
+
+            xml.writeEndElement();
+
+            start = stop;
+        }
+    }
+
+    xml.writeEndElement();
+    xml.writeEndDocument();
+
+    file.close();
+
+    return !xml.hasError() && file.error() == QFile::NoError;
+}
@@ -0,0 +1,48 @@
+#ifndef DATASETGENERATOR_H
+#define DATASETGENERATOR_H
+
+#include <QDate>
+#include <QString>
+#include <QStringList>
+
+// Writes synthetic provider playlists and the matching XMLTV files for load
+// tests. The output only depends on the seed and the settings, it contains
+// the oddities of real provider files: commas and apostrophes in names, missing
+// attributes, duplicate urls, vlc options and programmes across midnight.
+
+class DatasetGenerator
+{
+public:
+    explicit DatasetGenerator(quint64 seed = 1);
+
+    void setGroups(int groups);
+    void setChannels(int channels);
+    void setEpgDays(int days);
+    void setEpgStart(const QDate &date);
+    void setUrlPattern(const QString &pattern);
+    void setLogoPattern(const QString &pattern);
+
+    QString groupTitle(int group) const;
+    QString channelName(int channel) const;
+
+    bool writeM3u(const QString &fileName);
+    bool writeXmltv(const QString &fileName);
+
+private:
+    quint64 random();
+    int     random(int bound);
+    bool    chance(int percent);
+
+    QString channelId(int channel) const;
+
+    quint64 m_seed;
+    quint64 m_state;
+    int     m_groups;
+    int     m_channels;
+    int     m_epgDays;
+    QDate   m_epgStart;
+    QString m_urlPattern;
+    QString m_logoPattern;
+};
+
+#endif // DATASETGENERATOR_H
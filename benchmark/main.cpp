@@ -0,0 +1,119 @@
+#include "benchmark.h"
+#include "datasetgenerator.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDate>
+
+// the synthetic files only need the command line, no QApplication
+static bool isGenerator(int argc, char *argv[])
+{
+    for ( int i = 1; i < argc; i++ ) {
+        const QByteArray arg(argv[i]);
+        if ( arg == "--generate-m3u" || arg == "--generate-epg" ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int runGenerator(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationName("Freeware");
+    QCoreApplication::setApplicationName("m3uMan");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("m3uMan dataset generator");
+    parser.addHelpOption();
+
+    QCommandLineOption generateM3uOption("generate-m3u", "Write a synthetic m3u <file>.", "file");
+    QCommandLineOption generateEpgOption("generate-epg", "Write the matching synthetic xmltv <file>.", "file");
+    QCommandLineOption seedOption("seed", "Seed of the synthetic data.", "seed", "1");
+    QCommandLineOption groupsOption("groups", "Number of synthetic groups.", "groups", "50");
+    QCommandLineOption channelsOption("channels", "Number of synthetic channels.", "channels", "10000");
+    QCommandLineOption epgDaysOption("epg-days", "Days of synthetic EPG per channel.", "days", "7");
+    QCommandLineOption epgStartOption("epg-start", "First day of the synthetic EPG, default today.", "yyyy-MM-dd",
+                                      QDate::currentDate().toString(Qt::ISODate));
+    QCommandLineOption urlPatternOption("url-pattern", "Synthetic stream url, %1 group, %2 channel.", "pattern");
+    QCommandLineOption logoPatternOption("logo-pattern", "Synthetic logo url, %1 channel.", "pattern");
+
+    parser.addOption(generateM3uOption);
+    parser.addOption(generateEpgOption);
+    parser.addOption(seedOption);
+    parser.addOption(groupsOption);
+    parser.addOption(channelsOption);
+    parser.addOption(epgDaysOption);
+    parser.addOption(epgStartOption);
+    parser.addOption(urlPatternOption);
+    parser.addOption(logoPatternOption);
+
+    parser.process(a);
+
+    DatasetGenerator generator(parser.value(seedOption).toULongLong());
+
+    generator.setGroups(parser.value(groupsOption).toInt());
+    generator.setChannels(parser.value(channelsOption).toInt());
+    generator.setEpgDays(parser.value(epgDaysOption).toInt());
+    generator.setEpgStart(QDate::fromString(parser.value(epgStartOption), Qt::ISODate));
+
+    if ( parser.isSet(urlPatternOption) ) {
+        generator.setUrlPattern(parser.value(urlPatternOption));
+    }
+    if ( parser.isSet(logoPatternOption) ) {
+        generator.setLogoPattern(parser.value(logoPatternOption));
+    }
+
+    if ( parser.isSet(generateM3uOption) && ! generator.writeM3u(parser.value(generateM3uOption)) ) {
+        return 1;
+    }
+
+    if ( parser.isSet(generateEpgOption) && ! generator.writeXmltv(parser.value(generateEpgOption)) ) {
+        return 1;
+    }
+
+    return 0;
+}
+
+// the tree population needs widgets, so the benchmark runs in a QApplication
+static int runBenchmark(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationName("Freeware");
+    QCoreApplication::setApplicationName("m3uMan");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("m3uMan benchmark");
+    parser.addHelpOption();
+
+    QCommandLineOption benchmarkOption("benchmark", "Run the benchmarks and write the results into <file>.", "file", "benchmark.json");
+    QCommandLineOption sizesOption("benchmark-sizes", "Comma separated numbers of m3u <entries>.", "entries", "10000,100000,1000000");
+
+    parser.addOption(benchmarkOption);
+    parser.addOption(sizesOption);
+
+    parser.process(a);
+
+    QList<int> sizes;
+
+    foreach (const QString &size, parser.value(sizesOption).split(',')) {
+        if ( ! size.isEmpty() ) {
+            sizes << size.toInt();
+        }
+    }
+
+    Benchmark benchmark(sizes);
+
+    return benchmark.run(parser.value(benchmarkOption)) ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if ( isGenerator(argc, argv) ) {
+        return runGenerator(argc, argv);
+    }
+
+    return runBenchmark(argc, argv);
+}
@@ -0,0 +1,34 @@
+# Import, database and export code shared by the application and the
+# benchmark in benchmark/benchmark.pro.
+
+QT       += sql core network concurrent widgets
+
+LIBS     += -lz -llzma
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+        $$PWD/dbmanager.cpp \
+        $$PWD/m3uimporter.cpp \
+        $$PWD/m3uparser.cpp \
+        $$PWD/importworker.cpp \
+        $$PWD/streamdownloader.cpp \
+        $$PWD/m3uexporter.cpp \
+        $$PWD/epgimporter.cpp \
+        $$PWD/epgparser.cpp \
+        $$PWD/streamdecompressor.cpp \
+        $$PWD/epgdownloader.cpp \
+        $$PWD/stationtree.cpp
+
+HEADERS += \
+        $$PWD/dbmanager.h \
+        $$PWD/m3uimporter.h \
+        $$PWD/m3uparser.h \
+        $$PWD/importworker.h \
+        $$PWD/streamdownloader.h \
+        $$PWD/m3uexporter.h \
+        $$PWD/epgimporter.h \
+        $$PWD/epgparser.h \
+        $$PWD/streamdecompressor.h \
+        $$PWD/epgdownloader.h \
+        $$PWD/stationtree.h
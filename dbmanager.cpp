@@ -1,55 +1,319 @@
 #include "dbmanager.h"
 
+#include <QAtomicInt>
 #include <QDebug>
+#include <QDateTime>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QThread>
+#include <QThreadStorage>
 
-DbManager::DbManager()
+// a connection of one thread, with the statements prepared on it
+struct DbConnection
 {
+    QSqlDatabase                 db;
+    QHash<QString, DbStatement*> statements;
+    int                          stationIndex = -1;
+
+    ~DbConnection()
+    {
+        const QString connectionName = db.connectionName();
+
+        qDeleteAll(statements);
+
+        if ( db.isOpen() ) {
+            db.close();
+        }
+
+        if ( db.isValid() ) {
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(connectionName);
+        }
+    }
+};
+
+// the connections of a thread, closed when the thread ends
+struct DbThreadConnections
+{
+    QHash<QString, DbConnection*> connections;
+
+    ~DbThreadConnections()
+    {
+        qDeleteAll(connections);
+    }
+};
+
+static QThreadStorage<DbThreadConnections*> threadConnections;
+static QAtomicInt managers;
+
+// a LIKE pattern that filters at all, "" and "%%" match every station
+static bool isSearch(const QString &pattern)
+{
+    for ( int i = 0; i < pattern.size(); i++ ) {
+        if ( pattern.at(i) != QLatin1Char('%') ) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
-DbManager::~DbManager()
+// extinf.id, tvg_name, tvg_id, group_id, tvg_logo, url, state, groups.group_title, groups.favorite
+static void readExtinfRow(const QSqlQuery &query, ExtinfRow &row)
+{
+    row.id = query.value(0).toInt();
+    row.tvg_name = query.value(1).toString();
+    row.tvg_id = query.value(2).toString();
+    row.group_id = query.value(3).toInt();
+    row.tvg_logo = query.value(4).toString();
+    row.url = query.value(5).toString();
+    row.state = query.value(6).toInt();
+    row.group_title = query.value(7).toString();
+    row.group_favorite = query.value(8).toInt();
+}
+
+DbManager::DbManager() :
+    m_journal(JournalWal)
+{
+}
+
+DbCursor::DbCursor() :
+    m_statement(nullptr),
+    m_owned(false)
+{
+}
+
+DbCursor::DbCursor(DbStatement* statement, bool owned) :
+    m_statement(statement),
+    m_owned(owned)
 {
-    if (m_db.isOpen()) {
-        m_db.close();
+}
+
+DbCursor::DbCursor(DbCursor&& other) :
+    m_statement(other.m_statement),
+    m_owned(other.m_owned)
+{
+    other.m_statement = nullptr;
+}
+
+DbCursor& DbCursor::operator=(DbCursor&& other)
+{
+    if ( this != &other ) {
+        this->release();
+        m_statement = other.m_statement;
+        m_owned = other.m_owned;
+        other.m_statement = nullptr;
     }
+
+    return *this;
 }
 
-bool DbManager::open(const QString& path)
+DbCursor::~DbCursor()
 {
-    QSqlQuery query;
+    this->release();
+}
 
-    m_db = QSqlDatabase::addDatabase("QSQLITE");
-    m_db.setDatabaseName(path);
+void DbCursor::release()
+{
+    if ( m_statement == nullptr ) {
+        return;
+    }
 
-    qDebug() << "open database" << path;
+    if ( m_owned ) {
+        delete m_statement;
+    } else {
+        // keep the prepared statement, only drop the result set
+        m_statement->query.finish();
+        m_statement->busy = false;
+    }
 
-    return m_db.open();
+    m_statement = nullptr;
 }
 
-bool DbManager::isOpen()
+DbManager::~DbManager()
 {
-    return m_db.isOpen();
+    this->closeConnection();
 }
 
-bool DbManager::createTable()
+bool DbManager::open(const QString& path, const QString& connectionName)
 {
-    bool success = false;
+    this->closeConnection();
+
+    m_path = path;
+    m_key = QString("%1#%2").arg(connectionName).arg(managers.fetchAndAddRelaxed(1));
+
+    return this->connection()->db.isOpen();
+}
 
-    QSqlQuery query;
+// the connection of the calling thread, opened with the first use in that thread
+DbConnection* DbManager::connection()
+{
+    if ( ! threadConnections.hasLocalData() ) {
+        threadConnections.setLocalData(new DbThreadConnections);
+    }
+
+    QHash<QString, DbConnection*> &connections = threadConnections.localData()->connections;
+    DbConnection* connection = connections.value(m_key, nullptr);
+
+    if ( connection == nullptr ) {
+        connection = new DbConnection;
+        connections.insert(m_key, connection);
+
+        if ( ! m_path.isEmpty() ) {
+            this->openConnection(connection->db);
+        }
+    }
+
+    return connection;
+}
+
+void DbManager::closeConnection()
+{
+    if ( threadConnections.hasLocalData() ) {
+        delete threadConnections.localData()->connections.take(m_key);
+    }
+}
+
+bool DbManager::openConnection(QSqlDatabase& db)
+{
+    const QString connectionName = QString("%1@%2").arg(m_key).arg(quintptr(QThread::currentThreadId()), 0, 16);
+
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(m_path);
+
+    qDebug() << "open database" << m_path << connectionName;
+
+    if ( ! db.open() ) {
+        qDebug() << "open database fails!" << db.lastError();
+        return false;
+    }
+
+    // the pragmas are set per connection
+
+    QSqlQuery query(db);
 
     if (!query.exec("PRAGMA foreign_keys = ON")) {
         qDebug() << "set PRAGME foreign_keys fails!" <<  query.lastError();
     }
 
-    if (!query.exec("PRAGMA synchronous = OFF")) {
-        qDebug() << "set PRAGME synchronous fails!" <<  query.lastError();
+    if ( m_journal == JournalMemory ) {
+
+        if (!query.exec("PRAGMA synchronous = OFF")) {
+            qDebug() << "set PRAGME synchronous fails!" <<  query.lastError();
+        }
+
+        if (!query.exec("PRAGMA journal_mode = MEMORY")) {
+            qDebug() << "set PRAGME journal_mode fails!" <<  query.lastError();
+        }
+
+    } else {
+
+        // a crash loses at most the last commits, never the database
+        if (!query.exec("PRAGMA journal_mode = WAL") || !query.next() || query.value(0).toString() != "wal") {
+            qDebug() << "set PRAGME journal_mode WAL fails!" <<  query.lastError();
+        }
+
+        if (!query.exec("PRAGMA synchronous = NORMAL")) {
+            qDebug() << "set PRAGME synchronous fails!" <<  query.lastError();
+        }
+
+        // checkpoint every 40 MB of log instead of 4 MB, the imports write a lot,
+        // and cut the log file back once it was checkpointed
+        if (!query.exec("PRAGMA wal_autocheckpoint = 10000")) {
+            qDebug() << "set PRAGME wal_autocheckpoint fails!" <<  query.lastError();
+        }
+
+        if (!query.exec("PRAGMA journal_size_limit = 67108864")) {
+            qDebug() << "set PRAGME journal_size_limit fails!" <<  query.lastError();
+        }
+    }
+
+    // 32 MB page cache and 256 MB of the file mapped for the reads
+    if (!query.exec("PRAGMA cache_size = -32768")) {
+        qDebug() << "set PRAGME cache_size fails!" <<  query.lastError();
     }
 
-    if (!query.exec("PRAGMA journal_mode = MEMORY")) {
-        qDebug() << "set PRAGME journal_mode fails!" <<  query.lastError();
+    if (!query.exec("PRAGMA mmap_size = 268435456")) {
+        qDebug() << "set PRAGME mmap_size fails!" <<  query.lastError();
     }
 
+    return true;
+}
+
+void DbManager::setJournal(Journal journal)
+{
+    m_journal = journal;
+}
+
+// moves the log written by an import into the database, without waiting for the readers
+bool DbManager::checkpoint()
+{
+    if ( m_journal != JournalWal ) {
+        return true;
+    }
+
+    QSqlQuery query(this->database());
+
+    if ( ! query.exec("PRAGMA wal_checkpoint(PASSIVE)") ) {
+        qDebug() << "checkpoint" << query.lastError();
+        return false;
+    }
+
+    return true;
+}
+
+// the statements are prepared once per connection and kept by their SQL text,
+// a statement still in use by another cursor is prepared again just for this call
+DbCursor DbManager::prepare(const QString& sql, bool forwardOnly)
+{
+    DbConnection* connection = this->connection();
+    DbStatement* statement = connection->statements.value(sql, nullptr);
+    bool owned = false;
+
+    if ( statement != nullptr && statement->busy ) {
+        statement = nullptr;
+        owned = true;
+    }
+
+    if ( statement == nullptr ) {
+        statement = new DbStatement(connection->db);
+        statement->query.setForwardOnly(forwardOnly);
+
+        if ( ! statement->query.prepare(sql) ) {
+            qDebug() << "prepare" << statement->query.lastError() << sql;
+            owned = true;
+        }
+
+        if ( ! owned ) {
+            connection->statements.insert(sql, statement);
+        }
+    }
+
+    statement->busy = true;
+
+    return DbCursor(statement, owned);
+}
+
+QSqlDatabase DbManager::database()
+{
+    return this->connection()->db;
+}
+
+bool DbManager::isOpen()
+{
+    if ( m_path.isEmpty() ) {
+        return false;
+    }
+
+    return this->connection()->db.isOpen();
+}
+
+bool DbManager::createTable()
+{
+    bool success = false;
+
+    QSqlQuery query(this->database());
+
     query.prepare("CREATE TABLE IF NOT EXISTS "
                   "groups (id          INTEGER PRIMARY KEY AUTOINCREMENT, "
                   "        group_title TEXT, "
@@ -75,6 +339,8 @@ bool DbManager::createTable()
                   "        tvg_logo    TEXT, "
                   "        url         TEXT, "
                   "        state       INTEGER, "
+                  "        last_seen   INTEGER DEFAULT 0, "
+                  "        fingerprint INTEGER DEFAULT 0, "
                   "FOREIGN KEY(group_id) REFERENCES groups(id) ON DELETE CASCADE)");
 
     if (!query.exec()) {
@@ -82,6 +348,41 @@ bool DbManager::createTable()
         success = false;
     }
 
+    if ( ! this->addColumn("extinf", "last_seen", "INTEGER DEFAULT 0") ) {
+        success = false;
+    }
+
+    if ( ! this->addColumn("extinf", "fingerprint", "INTEGER DEFAULT 0") ) {
+        success = false;
+    }
+
+    query.prepare("DROP INDEX IF EXISTS idx_extinf_last_seen;");
+
+    if (!query.exec()) {
+        qDebug() << "dropIndex idx_extinf_last_seen " <<  query.lastError();
+        success = false;
+    }
+
+    query.prepare("CREATE INDEX IF NOT EXISTS idx_extinf_state_last_seen ON extinf(state, last_seen);");
+
+    if (!query.exec()) {
+        qDebug() << "createIndex idx_extinf_state_last_seen " <<  query.lastError();
+        success = false;
+    }
+
+    // Tabelle import_run (one row per m3u import, extinf.last_seen refers to it)
+
+    query.prepare("CREATE TABLE IF NOT EXISTS "
+                  "import_run (id       INTEGER PRIMARY KEY AUTOINCREMENT, "
+                  "            started  INTEGER, "
+                  "            finished INTEGER, "
+                  "            entries  INTEGER DEFAULT 0)");
+
+    if (!query.exec()) {
+        qDebug() << "createTable import_run" <<  query.lastError();
+        success = false;
+    }
+
     query.prepare("CREATE INDEX IF NOT EXISTS idx_group_id ON extinf(group_id);");
 
     if (!query.exec()) {
@@ -148,32 +449,70 @@ bool DbManager::createTable()
         success = false;
     }
 
-    // Tabelle program (EPG Daten)
+    // Tabelle program (EPG Daten, start and stop as UTC epoch seconds)
+
+    // the EPG of an old layout is dropped, the next import refills it
+    if ( this->columnType("program", "start") == "TEXT" || ! this->columnType("program", "title").isEmpty() ) {
+
+        query.prepare("DROP TABLE program");
+
+        if (!query.exec()) {
+            qDebug() << "dropTable program" <<  query.lastError();
+            success = false;
+        }
+    }
 
     query.prepare("CREATE TABLE IF NOT EXISTS "
                   "program (id          INTEGER PRIMARY KEY AUTOINCREMENT, "
-                  "         start       TEXT, "
-                  "         stop        TEXT, "
+                  "         start       INTEGER, "
+                  "         stop        INTEGER, "
                   "         channel     TEXT, "
-                  "         title       TEXT, "
-                  "         desc        TEXT)");
+                  "         title_id    INTEGER, "
+                  "         desc_id     INTEGER)");
 
     if (!query.exec()) {
         qDebug() << "createTable program" <<  query.lastError();
         success = false;
     }
 
-    query.prepare("CREATE INDEX IF NOT EXISTS idx_program_channel ON program(channel)");
+    // Tabelle epg_text (titles and descriptions of the EPG, once per text, keyed by its hash)
+
+    query.prepare("CREATE TABLE IF NOT EXISTS "
+                  "epg_text (id          INTEGER PRIMARY KEY, "
+                  "          compressed  INTEGER DEFAULT 0, "
+                  "          text)");
+
+    if (!query.exec()) {
+        qDebug() << "createTable epg_text" <<  query.lastError();
+        success = false;
+    }
+
+    query.prepare("CREATE UNIQUE INDEX IF NOT EXISTS idx_program_channel_start_stop ON program(channel, start, stop)");
+
+    if (!query.exec()) {
+        qDebug() << "createIndex idx_program_channel_start_stop " <<  query.lastError();
+        success = false;
+    }
+
+    query.prepare("CREATE INDEX IF NOT EXISTS idx_program_stop ON program(stop)");
+
+    if (!query.exec()) {
+        qDebug() << "createIndex idx_program_stop " <<  query.lastError();
+        success = false;
+    }
+
+    // the orphaned epg_text rows are found by a seek per text
+    query.prepare("CREATE INDEX IF NOT EXISTS idx_program_title_id ON program(title_id)");
 
     if (!query.exec()) {
-        qDebug() << "createIndex idx_program_channel " <<  query.lastError();
+        qDebug() << "createIndex idx_program_title_id " <<  query.lastError();
         success = false;
     }
 
-    query.prepare("CREATE UNIQUE INDEX IF NOT EXISTS idx_program_uk1 ON program(start, stop, channel)");
+    query.prepare("CREATE INDEX IF NOT EXISTS idx_program_desc_id ON program(desc_id)");
 
     if (!query.exec()) {
-        qDebug() << "createIndex idx_program_uk1 " <<  query.lastError();
+        qDebug() << "createIndex idx_program_desc_id " <<  query.lastError();
         success = false;
     }
 
@@ -189,27 +528,197 @@ bool DbManager::createTable()
         success = false;
     }
 
+    // Tabelle extinf_fts (trigram index of the station search, rowid = extinf.id)
+    // needs FTS5 and SQLite 3.34, without it the search scans extinf with LIKE
+
+    if ( ! this->columnExists("extinf_fts", "tvg_name") ) {
+
+        query.prepare("CREATE VIRTUAL TABLE IF NOT EXISTS "
+                      "extinf_fts USING fts5(tvg_name, group_title, tvg_id, tokenize = 'trigram')");
+
+        if (!query.exec()) {
+            qDebug() << "createTable extinf_fts, station search without index" <<  query.lastError();
+        } else {
+
+            query.prepare("INSERT INTO extinf_fts (rowid, tvg_name, group_title, tvg_id) "
+                          "SELECT extinf.id, extinf.tvg_name, groups.group_title, extinf.tvg_id "
+                          "FROM   extinf LEFT JOIN groups ON groups.id = extinf.group_id");
+
+            if (!query.exec()) {
+                qDebug() << "fill extinf_fts" <<  query.lastError();
+                success = false;
+            }
+        }
+    }
+
+    if ( this->columnExists("extinf_fts", "tvg_name") ) {
+
+        // the triggers keep the index in step with extinf and the group titles
+
+        query.prepare("CREATE TRIGGER IF NOT EXISTS extinf_fts_insert AFTER INSERT ON extinf BEGIN "
+                      "  INSERT INTO extinf_fts (rowid, tvg_name, group_title, tvg_id) "
+                      "  VALUES (new.id, new.tvg_name, (SELECT group_title FROM groups WHERE id = new.group_id), new.tvg_id); "
+                      "END");
+
+        if (!query.exec()) {
+            qDebug() << "createTrigger extinf_fts_insert" <<  query.lastError();
+            success = false;
+        }
+
+        query.prepare("CREATE TRIGGER IF NOT EXISTS extinf_fts_delete AFTER DELETE ON extinf BEGIN "
+                      "  DELETE FROM extinf_fts WHERE rowid = old.id; "
+                      "END");
+
+        if (!query.exec()) {
+            qDebug() << "createTrigger extinf_fts_delete" <<  query.lastError();
+            success = false;
+        }
+
+        query.prepare("CREATE TRIGGER IF NOT EXISTS extinf_fts_update AFTER UPDATE OF tvg_name, tvg_id, group_id ON extinf BEGIN "
+                      "  UPDATE extinf_fts SET tvg_name = new.tvg_name, "
+                      "                        group_title = (SELECT group_title FROM groups WHERE id = new.group_id), "
+                      "                        tvg_id = new.tvg_id "
+                      "  WHERE rowid = new.id; "
+                      "END");
+
+        if (!query.exec()) {
+            qDebug() << "createTrigger extinf_fts_update" <<  query.lastError();
+            success = false;
+        }
+
+        query.prepare("CREATE TRIGGER IF NOT EXISTS groups_fts_update AFTER UPDATE OF group_title ON groups BEGIN "
+                      "  UPDATE extinf_fts SET group_title = new.group_title "
+                      "  WHERE rowid IN (SELECT id FROM extinf WHERE group_id = new.id); "
+                      "END");
+
+        if (!query.exec()) {
+            qDebug() << "createTrigger groups_fts_update" <<  query.lastError();
+            success = false;
+        }
+    }
+
+    // decided again with the next search
+    this->connection()->stationIndex = -1;
+
     return success;
 }
 
+// whether the station search can use extinf_fts on this connection
+bool DbManager::hasStationIndex()
+{
+    DbConnection* connection = this->connection();
+
+    if ( connection->stationIndex < 0 ) {
+        connection->stationIndex = this->columnExists("extinf_fts", "tvg_name") ? 1 : 0;
+    }
+
+    return connection->stationIndex == 1;
+}
+
+QString DbManager::columnType(const QString& table, const QString& column)
+{
+    QSqlQuery query(this->database());
+
+    if ( ! query.exec(QString("PRAGMA table_info(%1)").arg(table)) ) {
+        qDebug() << "columnType" << table << query.lastError();
+        return QString();
+    }
+
+    while ( query.next() ) {
+        if ( query.value(1).toString() == column ) {
+            return query.value(2).toString().toUpper();
+        }
+    }
+
+    return QString();
+}
+
+bool DbManager::columnExists(const QString& table, const QString& column)
+{
+    QSqlQuery query(this->database());
+
+    if ( ! query.exec(QString("PRAGMA table_info(%1)").arg(table)) ) {
+        qDebug() << "columnExists" << table << query.lastError();
+        return false;
+    }
+
+    while ( query.next() ) {
+        if ( query.value(1).toString() == column ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool DbManager::addColumn(const QString& table, const QString& column, const QString& definition)
+{
+    if ( this->columnExists(table, column) ) {
+        return true;
+    }
+
+    QSqlQuery query(this->database());
+
+    if ( ! query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition)) ) {
+        qDebug() << "addColumn" << table << column << query.lastError();
+        return false;
+    }
+
+    return true;
+}
+
+bool DbManager::transaction()
+{
+    QSqlDatabase db = this->database();
+
+    if ( ! db.transaction() ) {
+        qDebug() << "transaction" << db.lastError();
+        return false;
+    }
+
+    return true;
+}
+
+bool DbManager::commit()
+{
+    QSqlDatabase db = this->database();
+
+    if ( ! db.commit() ) {
+        qDebug() << "commit" << db.lastError();
+        return false;
+    }
+
+    return true;
+}
+
+bool DbManager::rollback()
+{
+    QSqlDatabase db = this->database();
+
+    if ( ! db.rollback() ) {
+        qDebug() << "rollback" << db.lastError();
+        return false;
+    }
+
+    return true;
+}
+
 int DbManager::insertEXTINF(const QString& tvg_name, const QString& tvg_id, int group_id, const QString& tvg_logo, const QString& url)
 {
    int id = 0;
 
-   QSqlQuery query;
-
-   query.prepare("INSERT INTO extinf (tvg_name, tvg_id, group_id, tvg_logo, url, state ) VALUES (:tvg_name, :tvg_id, :group_id, :tvg_logo, :url, :state)");
-   query.bindValue(":tvg_name", tvg_name);
-   query.bindValue(":tvg_id", tvg_id);
-   query.bindValue(":group_id", group_id);
-   query.bindValue(":tvg_logo", tvg_logo);
-   query.bindValue(":url", url);
-   query.bindValue(":state", 2);
+   DbCursor query = this->prepare("INSERT INTO extinf (tvg_name, tvg_id, group_id, tvg_logo, url, state ) VALUES (:tvg_name, :tvg_id, :group_id, :tvg_logo, :url, :state)");
+   query->bindValue(":tvg_name", tvg_name);
+   query->bindValue(":tvg_id", tvg_id);
+   query->bindValue(":group_id", group_id);
+   query->bindValue(":tvg_logo", tvg_logo);
+   query->bindValue(":url", url);
+   query->bindValue(":state", 2);
 
-   if ( query.exec() ) {
-       id = query.lastInsertId().toInt();
+   if ( query->exec() ) {
+       id = query->lastInsertId().toInt();
    } else {
-       qDebug() << "addEXTINF" << query.lastError() << url;
+       qDebug() << "addEXTINF" << query->lastError() << url;
    }
 
    return id;
@@ -219,7 +728,7 @@ bool DbManager::removeAllEXTINFs()
 {
     bool success = false;
 
-    QSqlQuery query;
+    QSqlQuery query(this->database());
 
     if ( query.exec("DELETE FROM extinf") ) {
         success = true;
@@ -230,56 +739,144 @@ bool DbManager::removeAllEXTINFs()
     return success;
 }
 
-bool DbManager::removeObsoleteEXTINFs()
+bool DbManager::removeObsoleteEXTINFs(int run_id)
 {
     bool success = false;
 
-    QSqlQuery query;
+    DbCursor query = this->prepare("DELETE FROM extinf WHERE state = 0 AND last_seen <= :run_id");
+    query->bindValue(":run_id", run_id);
 
-    if ( query.exec("DELETE FROM extinf WHERE state = 0") ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "removeObsoleteEXTINFs" << query.lastError();
+        qDebug() << "removeObsoleteEXTINFs" << query->lastError();
     }
 
     return success;
 }
 
-QSqlQuery* DbManager::selectEXTINF(const QString& group_title, const QString& tvg_name, const QString& state, int favorite)
+int DbManager::countObsoleteEXTINFs(int run_id)
+{
+    int count = 0;
+
+    DbCursor query = this->prepare("SELECT count(*) FROM extinf WHERE state = 0 AND last_seen <= :run_id");
+    query->bindValue(":run_id", run_id);
+
+    if ( query->exec() && query->next() ) {
+        count = query->value(0).toInt();
+    } else {
+        qDebug() << "countObsoleteEXTINFs" << query->lastError();
+    }
+
+    return count;
+}
+
+int DbManager::insertImportRun()
+{
+    int id = 0;
+
+    DbCursor query = this->prepare("INSERT INTO import_run (started) VALUES (strftime('%s', 'now'))");
+
+    if ( query->exec() ) {
+        id = query->lastInsertId().toInt();
+    } else {
+        qDebug() << "insertImportRun" << query->lastError();
+    }
+
+    return id;
+}
+
+bool DbManager::finishImportRun(int id, int entries)
 {
-    QSqlQuery *select = new QSqlQuery();
+    bool success = false;
+
+    DbCursor query = this->prepare("UPDATE import_run SET finished = strftime('%s', 'now'), entries = :entries WHERE id = :id");
+    query->bindValue(":entries", entries);
+    query->bindValue(":id", id);
+
+    if ( query->exec() ) {
+        success = true;
+    } else {
+        qDebug() << "finishImportRun" << query->lastError();
+    }
+
+    return success;
+}
 
+bool DbManager::selectEXTINF(const QString& group_title, const QString& tvg_name, const QString& state, int favorite, std::vector<ExtinfRow>& rows)
+{
     //qDebug() << group_title <<tvg_name<<favorite<<state;
 
-    QString query = QString("SELECT *, "
-                            "( select count(*) from pls_item where pls_item.extinf_id = extinf.id ) "
-                            "FROM  extinf, "
-                            "      groups "
-                            "WHERE groups.id = extinf.group_id "
-                            "AND  (groups.favorite = :favorite OR :favorite = 0) "
-                            "AND  (groups.group_title LIKE :group_title OR :group_title = '') "
-                            "AND  (tvg_name LIKE :tvg_name OR :tvg_name = '') "
-                            "AND  (state = :state OR :state = '0') "
-                            "ORDER BY groups.group_title");
-
-    select->prepare( query );
+    rows.clear();
+
+    QString sql = "SELECT extinf.id, extinf.tvg_name, extinf.tvg_id, extinf.group_id, extinf.tvg_logo, extinf.url, extinf.state, "
+                  "       groups.group_title, groups.favorite, "
+                  "       ( select count(*) from pls_item where pls_item.extinf_id = extinf.id ) ";
+
+    bool searchGroup = isSearch(group_title);
+    bool searchName = isSearch(tvg_name);
+
+    if ( ( searchGroup || searchName ) && this->hasStationIndex() ) {
+
+        // the trigram index answers LIKE with leading wildcards, but only as a plain AND term
+        sql += "FROM  extinf_fts, "
+               "      extinf, "
+               "      groups "
+               "WHERE extinf.id = extinf_fts.rowid "
+               "AND   groups.id = extinf.group_id ";
+
+        if ( searchGroup ) {
+            sql += "AND   extinf_fts.group_title LIKE :group_title ";
+        }
+
+        if ( searchName ) {
+            sql += "AND   extinf_fts.tvg_name LIKE :tvg_name ";
+        }
+
+    } else {
+
+        sql += "FROM  extinf, "
+               "      groups "
+               "WHERE groups.id = extinf.group_id "
+               "AND  (groups.group_title LIKE :group_title OR :group_title = '') "
+               "AND  (extinf.tvg_name LIKE :tvg_name OR :tvg_name = '') ";
+
+        searchGroup = searchName = true;
+    }
+
+    sql += "AND  (groups.favorite = :favorite OR :favorite = 0) "
+           "AND  (extinf.state = :state OR :state = '0') "
+           "ORDER BY groups.group_title";
+
+    DbCursor select = this->prepare(sql, true);
     select->bindValue(":state", state);
     select->bindValue(":favorite", favorite);
-    select->bindValue(":group_title", group_title);
-    select->bindValue(":tvg_name", tvg_name);
+
+    if ( searchGroup ) {
+        select->bindValue(":group_title", group_title);
+    }
+
+    if ( searchName ) {
+        select->bindValue(":tvg_name", tvg_name);
+    }
 
     if ( ! select->exec() ) {
         qDebug() << "selectEXTINF" << select->lastError();
+        return false;
     }
 
-    return select;
+    while ( select->next() ) {
+        rows.emplace_back();
+        readExtinfRow(*select, rows.back());
+        rows.back().used = select->value(9).toInt();
+    }
+
+    return true;
 }
 
-QSqlQuery* DbManager::selectEXTINF_byUrl(const QString& url)
+DbCursor DbManager::selectEXTINF_byUrl(const QString& url)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare(QString("SELECT * FROM extinf WHERE url = :url"));
+    DbCursor select = this->prepare(QString("SELECT * FROM extinf WHERE url = :url"));
     select->bindValue(":url", url);
 
     if ( ! select->exec() ) {
@@ -289,24 +886,51 @@ QSqlQuery* DbManager::selectEXTINF_byUrl(const QString& url)
     return select;
 }
 
-QSqlQuery* DbManager::selectEXTINF_byRef(int id)
+DbCursor DbManager::selectEXTINF_urls()
 {
-    QSqlQuery *select = new QSqlQuery();
+    DbCursor select = this->prepare("SELECT id, url, fingerprint, state, group_id FROM extinf", true);
 
-    select->prepare("SELECT * FROM extinf, groups WHERE extinf.id = :id and groups.id = extinf.group_id");
-    select->bindValue(":id", id);
     if ( ! select->exec() ) {
-         qDebug() << "selectEXTINF_byRef" << id << select->lastError();
+        qDebug() << "selectEXTINF_urls" << select->lastError();
+    }
+
+    return select;
+}
+
+DbCursor DbManager::selectEXTINF_tvg_ids()
+{
+    DbCursor select = this->prepare("SELECT DISTINCT tvg_id FROM extinf WHERE trim(tvg_id) <> ''", true);
+
+    if ( ! select->exec() ) {
+        qDebug() << "selectEXTINF_tvg_ids" << select->lastError();
     }
 
     return select;
 }
 
-QSqlQuery* DbManager::countEXTINF_byState()
+bool DbManager::selectEXTINF_byRef(int id, ExtinfRow& row)
 {
-    QSqlQuery *select = new QSqlQuery();
+    DbCursor select = this->prepare("SELECT extinf.id, extinf.tvg_name, extinf.tvg_id, extinf.group_id, extinf.tvg_logo, extinf.url, extinf.state, "
+                                    "       groups.group_title, groups.favorite "
+                                    "FROM extinf, groups WHERE extinf.id = :id and groups.id = extinf.group_id", true);
+    select->bindValue(":id", id);
+    if ( ! select->exec() ) {
+         qDebug() << "selectEXTINF_byRef" << id << select->lastError();
+         return false;
+    }
+
+    if ( ! select->next() ) {
+        return false;
+    }
+
+    readExtinfRow(*select, row);
 
-    select->prepare("SELECT state, count(*) FROM extinf group by state");
+    return true;
+}
+
+DbCursor DbManager::countEXTINF_byState()
+{
+    DbCursor select = this->prepare("SELECT state, count(*) FROM extinf group by state");
 
     if ( ! select->exec() ) {
          qDebug() << "countEXTINF_byState"  << select->lastError();
@@ -319,9 +943,7 @@ bool DbManager::updateEXTINF_byRef(int id, const QString& tvg_name, int group_id
 {
     int retCode = true;
 
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("UPDATE extinf SET state = :state, group_id = :group_id, tvg_name = :tvg_name, tvg_logo =:tvg_logo WHERE id = :id");
+    DbCursor select = this->prepare("UPDATE extinf SET state = :state, group_id = :group_id, tvg_name = :tvg_name, tvg_logo =:tvg_logo WHERE id = :id");
     select->bindValue(":id", id);
     select->bindValue(":tvg_name", tvg_name);
     select->bindValue(":group_id", group_id);
@@ -333,8 +955,6 @@ bool DbManager::updateEXTINF_byRef(int id, const QString& tvg_name, int group_id
         retCode = false;
     }
 
-    delete select;
-
     return retCode;
 }
 
@@ -342,9 +962,7 @@ bool DbManager::updateEXTINF_tvg_name_byRef(int id, const QString& tvg_name)
 {
     int retCode = true;
 
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("UPDATE extinf SET tvg_name =:tvg_name WHERE id = :id");
+    DbCursor select = this->prepare("UPDATE extinf SET tvg_name =:tvg_name WHERE id = :id");
     select->bindValue(":id", id);
     select->bindValue(":tvg_name", tvg_name);
 
@@ -353,8 +971,6 @@ bool DbManager::updateEXTINF_tvg_name_byRef(int id, const QString& tvg_name)
         retCode = false;
     }
 
-    delete select;
-
     return retCode;
 }
 
@@ -362,9 +978,7 @@ bool DbManager::updateEXTINF_tvg_logo_byRef(int id, const QString& tvg_logo)
 {
     int retCode = true;
 
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("UPDATE extinf SET tvg_logo =:tvg_logo WHERE id = :id");
+    DbCursor select = this->prepare("UPDATE extinf SET tvg_logo =:tvg_logo WHERE id = :id");
     select->bindValue(":id", id);
     select->bindValue(":tvg_logo", tvg_logo);
 
@@ -373,8 +987,6 @@ bool DbManager::updateEXTINF_tvg_logo_byRef(int id, const QString& tvg_logo)
         retCode = false;
     }
 
-    delete select;
-
     return retCode;
 }
 
@@ -382,9 +994,7 @@ bool DbManager::updateEXTINF_tvg_logo_by_tvg_name(const QString& tvg_name, const
 {
     int retCode = true;
 
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("UPDATE extinf SET tvg_logo =:tvg_logo WHERE tvg_name = :tvg_name");
+    DbCursor select = this->prepare("UPDATE extinf SET tvg_logo =:tvg_logo WHERE tvg_name = :tvg_name");
     select->bindValue(":tvg_name", tvg_name);
     select->bindValue(":tvg_logo", tvg_logo);
 
@@ -393,8 +1003,6 @@ bool DbManager::updateEXTINF_tvg_logo_by_tvg_name(const QString& tvg_name, const
         retCode = false;
     }
 
-    delete select;
-
     return retCode;
 }
 
@@ -402,9 +1010,7 @@ bool DbManager::updateEXTINF_tvg_id_byRef(int id, const QString& tvg_id)
 {
     int retCode = true;
 
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("UPDATE extinf SET tvg_id =:tvg_id WHERE id = :id");
+    DbCursor select = this->prepare("UPDATE extinf SET tvg_id =:tvg_id WHERE id = :id");
     select->bindValue(":id", id);
     select->bindValue(":tvg_id", tvg_id);
 
@@ -413,8 +1019,6 @@ bool DbManager::updateEXTINF_tvg_id_byRef(int id, const QString& tvg_id)
         retCode = false;
     }
 
-    delete select;
-
     return retCode;
 }
 
@@ -422,9 +1026,7 @@ bool DbManager::updateEXTINF_url_byRef(int id, const QString& url)
 {
     int retCode = true;
 
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("UPDATE extinf SET url =:url WHERE id = :id");
+    DbCursor select = this->prepare("UPDATE extinf SET url =:url WHERE id = :id");
     select->bindValue(":id", id);
     select->bindValue(":url", url);
 
@@ -433,28 +1035,13 @@ bool DbManager::updateEXTINF_url_byRef(int id, const QString& url)
         retCode = false;
     }
 
-    delete select;
-
     return retCode;
 }
 
 
-bool DbManager::deactivateEXTINFs()
-{
-    QSqlQuery *select = new QSqlQuery();
-
-    select->exec("UPDATE extinf SET state = 0");
-
-    delete select;
-
-    return true;
-}
-
-QSqlQuery* DbManager::selectEXTINF_group_titles(int state)
+DbCursor DbManager::selectEXTINF_group_titles(int state)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("select distinct group_title from extinf WHERE (state = :state OR :state = 0) order by group_title");
+    DbCursor select = this->prepare("select distinct group_title from extinf WHERE (state = :state OR :state = 0) order by group_title");
     select->bindValue(":state", state);
 
     if ( ! select->exec() ) {
@@ -464,11 +1051,9 @@ QSqlQuery* DbManager::selectEXTINF_group_titles(int state)
     return select;
 }
 
-QSqlQuery* DbManager::selectPLS_by_pls_name(const QString& pls_name)
+DbCursor DbManager::selectPLS_by_pls_name(const QString& pls_name)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("SELECT * FROM pls WHERE pls_name = :pls_name");
+    DbCursor select = this->prepare("SELECT * FROM pls WHERE pls_name = :pls_name");
     select->bindValue(":pls_name", pls_name);
 
     if ( ! select->exec() ) {
@@ -478,11 +1063,9 @@ QSqlQuery* DbManager::selectPLS_by_pls_name(const QString& pls_name)
     return select;
 }
 
-QSqlQuery* DbManager::selectPLS(int favorite)
+DbCursor DbManager::selectPLS(int favorite)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("SELECT * FROM pls WHERE (favorite = :favorite OR :favorite = 0) ORDER BY pls_name");
+    DbCursor select = this->prepare("SELECT * FROM pls WHERE (favorite = :favorite OR :favorite = 0) ORDER BY pls_name");
     select->bindValue(":favorite", favorite);
 
     if ( ! select->exec() ) {
@@ -492,11 +1075,9 @@ QSqlQuery* DbManager::selectPLS(int favorite)
     return select;
 }
 
-QSqlQuery* DbManager::selectPLS_by_id(int id)
+DbCursor DbManager::selectPLS_by_id(int id)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("SELECT * FROM pls WHERE id = :id");
+    DbCursor select = this->prepare("SELECT * FROM pls WHERE id = :id");
     select->bindValue(":id", id);
 
     if ( ! select->exec() ) {
@@ -510,14 +1091,13 @@ bool DbManager::removePLS(int id)
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("DELETE FROM pls WHERE id = :id");
-    query.bindValue(":id", id);
+    DbCursor query = this->prepare("DELETE FROM pls WHERE id = :id");
+    query->bindValue(":id", id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "removePLS" << query.lastError();
+        qDebug() << "removePLS" << query->lastError();
     }
 
     return success;
@@ -528,15 +1108,14 @@ bool DbManager::updatePLS(int id, const QString & pls_name )
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("UPDATE pls SET pls_name = :pls_name WHERE id = :id");
-    query.bindValue(":pls_name", pls_name);
-    query.bindValue(":id", id);
+    DbCursor query = this->prepare("UPDATE pls SET pls_name = :pls_name WHERE id = :id");
+    query->bindValue(":pls_name", pls_name);
+    query->bindValue(":id", id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "updatePLS" << query.lastError();
+        qDebug() << "updatePLS" << query->lastError();
     }
 
     return success;
@@ -546,15 +1125,14 @@ bool DbManager::updatePLS_item_pls_pos(int id, int pls_pos )
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("UPDATE pls_item SET pls_pos = :pls_pos WHERE id = :id");
-    query.bindValue(":pls_pos", pls_pos);
-    query.bindValue(":id", id);
+    DbCursor query = this->prepare("UPDATE pls_item SET pls_pos = :pls_pos WHERE id = :id");
+    query->bindValue(":pls_pos", pls_pos);
+    query->bindValue(":id", id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "updatePLS_pls_pos" << query.lastError();
+        qDebug() << "updatePLS_pls_pos" << query->lastError();
     }
 
     return success;
@@ -565,15 +1143,14 @@ bool DbManager::updatePLS_favorite(int id, int favorite )
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("UPDATE pls SET favorite = :favorite WHERE id = :id");
-    query.bindValue(":favorite", favorite);
-    query.bindValue(":id", id);
+    DbCursor query = this->prepare("UPDATE pls SET favorite = :favorite WHERE id = :id");
+    query->bindValue(":favorite", favorite);
+    query->bindValue(":id", id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "updatePLS_favorite" << query.lastError();
+        qDebug() << "updatePLS_favorite" << query->lastError();
     }
 
     return success;
@@ -583,15 +1160,14 @@ bool DbManager::updatePLS_kind(int id, int kind )
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("UPDATE pls SET kind = :kind WHERE id = :id");
-    query.bindValue(":kind", kind);
-    query.bindValue(":id", id);
+    DbCursor query = this->prepare("UPDATE pls SET kind = :kind WHERE id = :id");
+    query->bindValue(":kind", kind);
+    query->bindValue(":id", id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "updatePLS_kind" << query.lastError();
+        qDebug() << "updatePLS_kind" << query->lastError();
     }
 
     return success;
@@ -601,15 +1177,14 @@ bool DbManager::updatePLS_item_favorite(int id, int favorite )
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("UPDATE pls_item SET favorite = :favorite WHERE id = :id");
-    query.bindValue(":favorite", favorite);
-    query.bindValue(":id", id);
+    DbCursor query = this->prepare("UPDATE pls_item SET favorite = :favorite WHERE id = :id");
+    query->bindValue(":favorite", favorite);
+    query->bindValue(":id", id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "updatePLS_favorite" << query.lastError();
+        qDebug() << "updatePLS_favorite" << query->lastError();
     }
 
     return success;
@@ -618,15 +1193,14 @@ bool DbManager::updatePLS_item_tmdb_by_extinf_id(int extinf_id, double tmdb_id )
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("UPDATE pls_item SET tmdb_id = :tmdb_id WHERE extinf_id = :extinf_id");
-    query.bindValue(":tmdb_id", tmdb_id);
-    query.bindValue(":extinf_id", extinf_id);
+    DbCursor query = this->prepare("UPDATE pls_item SET tmdb_id = :tmdb_id WHERE extinf_id = :extinf_id");
+    query->bindValue(":tmdb_id", tmdb_id);
+    query->bindValue(":extinf_id", extinf_id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "updatePLS_item_tmdb" << query.lastError();
+        qDebug() << "updatePLS_item_tmdb" << query->lastError();
     }
 
     return success;
@@ -636,15 +1210,14 @@ int DbManager::insertPLS(const QString & pls_name, int favorite)
 {
     int id = 0;
 
-    QSqlQuery query;
-    query.prepare("INSERT INTO pls (pls_name, favorite) VALUES (:pls_name, :favorite)");
-    query.bindValue(":pls_name", pls_name);
-    query.bindValue(":favorite", favorite);
+    DbCursor query = this->prepare("INSERT INTO pls (pls_name, favorite) VALUES (:pls_name, :favorite)");
+    query->bindValue(":pls_name", pls_name);
+    query->bindValue(":favorite", favorite);
 
-    if ( query.exec() ) {
-        id = query.lastInsertId().toInt();
+    if ( query->exec() ) {
+        id = query->lastInsertId().toInt();
     } else {
-        qDebug() << "insertPLS" << query.lastError();
+        qDebug() << "insertPLS" << query->lastError();
     }
 
     return id;
@@ -655,32 +1228,57 @@ int DbManager::insertPLS_Item(int pls_id, int extinf_id, int pls_pos )
 {
     int id = 0;
 
-    QSqlQuery query;
-    query.prepare("INSERT INTO pls_item (pls_id, extinf_id, pls_pos) VALUES (:pls_id, :extinf_id, :pls_pos )");
-    query.bindValue(":pls_id", pls_id);
-    query.bindValue(":extinf_id", extinf_id);
-    query.bindValue(":pls_pos", pls_pos);
+    DbCursor query = this->prepare("INSERT INTO pls_item (pls_id, extinf_id, pls_pos) VALUES (:pls_id, :extinf_id, :pls_pos )");
+    query->bindValue(":pls_id", pls_id);
+    query->bindValue(":extinf_id", extinf_id);
+    query->bindValue(":pls_pos", pls_pos);
 
-    if ( query.exec() ) {
-        id = query.lastInsertId().toInt();
+    if ( query->exec() ) {
+        id = query->lastInsertId().toInt();
     } else {
-        qDebug() << "insertPLS_Item" << query.lastError();
+        qDebug() << "insertPLS_Item" << query->lastError();
     }
 
     return id;
 }
 
-QSqlQuery* DbManager::selectPLS_Items(int pls_id, const QString& tvg_name, int onlyepg )
+DbCursor DbManager::selectPLS_Items_m3u(int pls_id)
+{
+    DbCursor select = this->prepare("SELECT extinf.tvg_name, extinf.tvg_id, extinf.tvg_logo, extinf.url "
+                                    "FROM   pls_item, extinf "
+                                    "WHERE  pls_id = :pls_id "
+                                    "AND    extinf.id = pls_item.extinf_id "
+                                    "ORDER BY pls_pos", true);
+
+    select->bindValue(":pls_id", pls_id);
+
+    if ( ! select->exec() ) {
+        qDebug() << "selectPLS_Items_m3u" << select->lastError();
+    }
+
+    return select;
+}
+
+bool DbManager::selectPLS_Items(int pls_id, const QString& tvg_name, int onlyepg, std::vector<PlsItemRow>& rows)
 {
-    QSqlQuery *select = new QSqlQuery();
+    rows.clear();
+
+    QString sql = "SELECT pls_item.id, pls_item.pls_id, pls_item.extinf_id, pls_item.pls_pos, pls_item.favorite, "
+                  "       extinf.tvg_name, extinf.tvg_id, extinf.tvg_logo, extinf.url "
+                  "FROM   pls_item, extinf "
+                  "WHERE  pls_id = :pls_id "
+                  "AND    extinf.id = pls_item.extinf_id ";
+
+    if ( isSearch(tvg_name) && this->hasStationIndex() ) {
+        sql += "AND    extinf.id IN ( SELECT rowid FROM extinf_fts WHERE tvg_name LIKE :tvg_name ) ";
+    } else {
+        sql += "AND    extinf.tvg_name like :tvg_name ";
+    }
+
+    sql += "AND    ( ( extinf.tvg_id <> ' ' AND :onlyepg = 1 ) OR ( :onlyepg = 0 ) ) "
+           "ORDER BY pls_pos";
 
-    select->prepare("SELECT * "
-                    "FROM   pls_item, extinf "
-                    "WHERE  pls_id = :pls_id "
-                    "AND    extinf.id = pls_item.extinf_id "
-                    "AND    extinf.tvg_name like :tvg_name "
-                    "AND    ( ( extinf.tvg_id <> ' ' AND :onlyepg = 1 ) OR ( :onlyepg = 0 ) ) "
-                    "ORDER BY pls_pos");
+    DbCursor select = this->prepare(sql, true);
 
     select->bindValue(":pls_id", pls_id);
     select->bindValue(":tvg_name", tvg_name);
@@ -688,16 +1286,30 @@ QSqlQuery* DbManager::selectPLS_Items(int pls_id, const QString& tvg_name, int o
 
     if ( ! select->exec() ) {
         qDebug() << "selectPLS_Item" << select->lastError() << select->lastQuery();
+        return false;
     }
 
-    return select;
+    while ( select->next() ) {
+        rows.emplace_back();
+
+        PlsItemRow &row = rows.back();
+        row.id = select->value(0).toInt();
+        row.pls_id = select->value(1).toInt();
+        row.extinf_id = select->value(2).toInt();
+        row.pls_pos = select->value(3).toInt();
+        row.favorite = select->value(4).toInt();
+        row.tvg_name = select->value(5).toString();
+        row.tvg_id = select->value(6).toString();
+        row.tvg_logo = select->value(7).toString();
+        row.url = select->value(8).toString();
+    }
+
+    return true;
 }
 
-QSqlQuery* DbManager::selectPLS_Items_by_extinf_id(int extinf_id)
+DbCursor DbManager::selectPLS_Items_by_extinf_id(int extinf_id)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("SELECT * FROM pls_item WHERE extinf_id = :extinf_id");
+    DbCursor select = this->prepare("SELECT * FROM pls_item WHERE extinf_id = :extinf_id");
     select->bindValue(":extinf_id", extinf_id);
 
     if ( ! select->exec() ) {
@@ -707,11 +1319,9 @@ QSqlQuery* DbManager::selectPLS_Items_by_extinf_id(int extinf_id)
     return select;
 }
 
-QSqlQuery* DbManager::selectPLS_Items_by_key(int pls_id, int extinf_id)
+DbCursor DbManager::selectPLS_Items_by_key(int pls_id, int extinf_id)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("SELECT * FROM pls_item WHERE pls_id = :pls_id and extinf_id = :extinf_id");
+    DbCursor select = this->prepare("SELECT * FROM pls_item WHERE pls_id = :pls_id and extinf_id = :extinf_id");
     select->bindValue(":extinf_id", extinf_id);
     select->bindValue(":pls_id", pls_id);
 
@@ -722,19 +1332,28 @@ QSqlQuery* DbManager::selectPLS_Items_by_key(int pls_id, int extinf_id)
     return select;
 }
 
+DbCursor DbManager::selectPLS_Items_keys()
+{
+    DbCursor select = this->prepare("SELECT pls_id, extinf_id FROM pls_item", true);
+
+    if ( ! select->exec() ) {
+        qDebug() << "selectPLS_Items_keys" << select->lastError();
+    }
+
+    return select;
+}
 
 bool DbManager::removePLS_Item(int id)
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("DELETE FROM pls_item WHERE id = :id");
-    query.bindValue(":id", id);
+    DbCursor query = this->prepare("DELETE FROM pls_item WHERE id = :id");
+    query->bindValue(":id", id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "removePLS_Item" << query.lastError();
+        qDebug() << "removePLS_Item" << query->lastError();
     }
 
     return success;
@@ -744,95 +1363,139 @@ bool DbManager::removePLS_Items(int pls_id)
 {
     bool success = false;
 
-    QSqlQuery query;
-    query.prepare("DELETE FROM pls_item WHERE pls_id = :pls_id");
-    query.bindValue(":pls_id", pls_id);
+    DbCursor query = this->prepare("DELETE FROM pls_item WHERE pls_id = :pls_id");
+    query->bindValue(":pls_id", pls_id);
 
-    if ( query.exec() ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "removePLS_Items" << query.lastError();
+        qDebug() << "removePLS_Items" << query->lastError();
     }
 
     return success;
 }
 
-bool DbManager::addProgram(const QString& start, const QString& stop,
-                           const QString& channel, const QString& title,
-                           const QString& desc)
+bool DbManager::compressEpgText(const QString& text, bool compress)
 {
-   bool success = false;
+    // short texts don't gain anything from zlib
+    return compress && text.size() >= 256;
+}
 
-   QSqlQuery query;
+qint64 DbManager::epgTextId(const QString& text, bool compressed)
+{
+    // 64 bit FNV-1a, equal texts share one row of epg_text
+    quint64 hash = Q_UINT64_C(14695981039346656037);
 
-   query.prepare("INSERT INTO program (start, stop, channel, title, desc ) VALUES (:start, :stop, :channel, :title, :desc)");
-   query.bindValue(":start", start);
-   query.bindValue(":stop", stop);
-   query.bindValue(":channel", channel);
-   query.bindValue(":title", title);
-   query.bindValue(":desc", desc);
+    const ushort *c = text.utf16();
+    for ( int i = 0; i < text.size(); i++ ) {
+        hash = ( hash ^ c[i] ) * Q_UINT64_C(1099511628211);
+    }
 
-   if ( query.exec() ) {
-       success = true;
-   } else {
-       if ( query.lastError().nativeErrorCode().toInt() != 19 ) {
-           qDebug() << "addProgram" << query.lastError();
-       } else {
-           // Program already there...
-       }
-   }
+    hash = ( hash ^ ( compressed ? 1 : 0 ) ) * Q_UINT64_C(1099511628211);
 
-   return success;
+    // 0 stands for no text
+    return hash == 0 ? 1 : qint64(hash);
+}
+
+QVariant DbManager::packEpgText(const QString& text, bool compressed)
+{
+    return compressed ? QVariant(qCompress(text.toUtf8())) : QVariant(text);
+}
+
+QString DbManager::unpackEpgText(const QVariant& text, bool compressed)
+{
+    return compressed ? QString::fromUtf8(qUncompress(text.toByteArray())) : text.toString();
 }
 
 bool DbManager::removeOldPrograms()
 {
     bool success = false;
 
-    QSqlQuery query;
+    DbCursor query = this->prepare("DELETE FROM program WHERE stop < :now");
+    query->bindValue(":now", QDateTime::currentDateTimeUtc().toSecsSinceEpoch());
 
-    if ( query.exec("DELETE FROM program WHERE stop < strftime('%Y%m%d%H%M%S +0000', 'now', 'localtime')") ) {
+    if ( query->exec() ) {
         success = true;
     } else {
-        qDebug() << "removeOldPrograms" << query.lastError();
+        qDebug() << "removeOldPrograms" << query->lastError();
+        return false;
+    }
+
+    // nothing expired, no text can have lost its last programme
+    if ( query->numRowsAffected() <= 0 ) {
+        return success;
+    }
+
+    // texts no programme refers to anymore, one index seek each
+    DbCursor orphans = this->prepare("DELETE FROM epg_text "
+                                     "WHERE  NOT EXISTS (SELECT 1 FROM program WHERE program.title_id = epg_text.id) "
+                                     "AND    NOT EXISTS (SELECT 1 FROM program WHERE program.desc_id = epg_text.id)");
+
+    if ( ! orphans->exec() ) {
+        qDebug() << "removeOldPrograms epg_text" << orphans->lastError();
+        success = false;
     }
 
     return success;
 }
 
-QSqlQuery* DbManager::selectActualProgramData(const QString &channel)
+bool DbManager::selectActualProgramData_byPls(int pls_id, std::vector<ProgramRow>& rows)
 {
-    QSqlQuery *select = new QSqlQuery();
+    rows.clear();
+
+    // the running programme of every station in the playlist, the last one
+    // started before now is a single backward seek in idx_program_channel_start_stop
+    DbCursor select = this->prepare("SELECT program.start, program.stop, program.channel, t.text "
+                                    "FROM   pls_item, extinf, program "
+                                    "LEFT JOIN epg_text t ON t.id = program.title_id "
+                                    "WHERE  pls_item.pls_id = :pls_id "
+                                    "AND    extinf.id = pls_item.extinf_id "
+                                    "AND    program.id = ( SELECT p.id FROM program p "
+                                    "                      WHERE  p.channel = extinf.tvg_id AND p.start <= :now "
+                                    "                      ORDER BY p.start DESC LIMIT 1 ) "
+                                    "AND    program.stop > :now", true);
+
+    select->bindValue(":pls_id", pls_id);
+    select->bindValue(":now", QDateTime::currentDateTimeUtc().toSecsSinceEpoch());
+
+    if ( ! select->exec() ) {
+        qDebug() << "selectActualProgramData_byPls" << select->lastError();
+        return false;
+    }
+
+    while ( select->next() ) {
+        rows.emplace_back();
+
+        ProgramRow &row = rows.back();
+        row.start = select->value(0).toLongLong();
+        row.stop = select->value(1).toLongLong();
+        row.channel = select->value(2).toString();
+        row.title = select->value(3).toString();
+    }
 
-    select->prepare("SELECT * FROM program WHERE strftime('%Y%m%d%H%M%S +0000', 'now', 'localtime') > start AND "
-                    "                            strftime('%Y%m%d%H%M%S +0000', 'now', 'localtime') < stop AND "
-                    "                            channel = :channel");
+    return true;
+}
 
+DbCursor DbManager::selectProgramTimeline(const QString &channel)
+{
+    // the texts are looked up by id when needed
+    DbCursor select = this->prepare("SELECT start, stop, title_id, desc_id FROM program WHERE channel = :channel ORDER BY start", true);
     select->bindValue(":channel", channel);
 
     if ( ! select->exec() ) {
-        qDebug() << "selectActualProgramData" << select->lastError();
+        qDebug() << "selectProgramTimeline" << select->lastError();
     }
 
     return select;
 }
 
-QSqlQuery* DbManager::selectProgramData(const QString &channel)
+DbCursor DbManager::selectEpgText(qint64 id)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("SELECT SUBSTR (start, 7, 2) || ' ' ||SUBSTR (start, 9, 2) || ':' || SUBSTR (start, 11, 2) || ':' || SUBSTR(start, 13, 2), "
-                    "       SUBSTR (start, 7, 2) || ' ' ||SUBSTR (stop,  9, 2) || ':' || SUBSTR (stop,  11, 2) || ':' || SUBSTR(stop,  13, 2), "
-                    "       title, "
-                    "       desc "
-                    "FROM   program "
-                    "WHERE  strftime('%Y%m%d%H%M%S +0000', 'now', 'localtime') < stop "
-                    "AND    channel = :channel");
-
-    select->bindValue(":channel", channel);
+    DbCursor select = this->prepare("SELECT text, compressed FROM epg_text WHERE id = :id", true);
+    select->bindValue(":id", id);
 
     if ( ! select->exec() ) {
-        qDebug() << "selectProgramData" << select->lastError();
+        qDebug() << "selectEpgText" << select->lastError();
     }
 
     return select;
@@ -842,16 +1505,14 @@ int DbManager::addGroup(const QString& group_title)
 {
    int id = 0;
 
-   QSqlQuery query;
-
-   query.prepare("INSERT INTO groups (group_title, favorite ) VALUES (:group_title, :favorite)");
-   query.bindValue(":group_title", group_title);
-   query.bindValue(":favorite", 0);
+   DbCursor query = this->prepare("INSERT INTO groups (group_title, favorite ) VALUES (:group_title, :favorite)");
+   query->bindValue(":group_title", group_title);
+   query->bindValue(":favorite", 0);
 
-   if ( query.exec() ) {
-        id = query.lastInsertId().toInt();
+   if ( query->exec() ) {
+        id = query->lastInsertId().toInt();
    } else {
-        qDebug() << "addGroup" << query.lastError() << group_title;
+        qDebug() << "addGroup" << query->lastError() << group_title;
    }
 
    return id;
@@ -861,17 +1522,15 @@ bool DbManager::updateGroup(int id, const QString& group_title, int favorite)
 {
    bool success = false;
 
-   QSqlQuery query;
+   DbCursor query = this->prepare("UPDATE groups SET group_title = :group_title, favorite = :favorite WHERE id = :id");
+   query->bindValue(":group_title", group_title);
+   query->bindValue(":favorite", favorite);
+   query->bindValue(":id", id);
 
-   query.prepare("UPDATE groups SET group_title = :group_title, favorite = :favorite WHERE id = :id");
-   query.bindValue(":group_title", group_title);
-   query.bindValue(":favorite", favorite);
-   query.bindValue(":id", id);
-
-   if ( query.exec() ) {
+   if ( query->exec() ) {
         success = true;
    } else {
-        qDebug() << "updateGroup" << query.lastError() << id << group_title << favorite;
+        qDebug() << "updateGroup" << query->lastError() << id << group_title << favorite;
    }
 
    return success;
@@ -881,27 +1540,23 @@ bool DbManager::updateGroupFavorite(int id, int favorite)
 {
    bool success = false;
 
-   QSqlQuery query;
-
-   query.prepare("UPDATE groups SET favorite = :favorite WHERE id = :id");
-   query.bindValue(":favorite", favorite);
-   query.bindValue(":id", id);
+   DbCursor query = this->prepare("UPDATE groups SET favorite = :favorite WHERE id = :id");
+   query->bindValue(":favorite", favorite);
+   query->bindValue(":id", id);
 
-   if ( query.exec() ) {
+   if ( query->exec() ) {
         success = true;
    } else {
-        qDebug() << "updateGroupFavorite" << query.lastError() << id <<  favorite;
+        qDebug() << "updateGroupFavorite" << query->lastError() << id <<  favorite;
    }
 
    return success;
 }
 
 
-QSqlQuery* DbManager::selectGroup_byTitle(const QString& group_title)
+DbCursor DbManager::selectGroup_byTitle(const QString& group_title)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("SELECT * FROM groups WHERE group_title = :group_title");
+    DbCursor select = this->prepare("SELECT * FROM groups WHERE group_title = :group_title");
     select->bindValue(":group_title", group_title);
 
     if ( ! select->exec() ) {
@@ -911,11 +1566,9 @@ QSqlQuery* DbManager::selectGroup_byTitle(const QString& group_title)
     return select;
 }
 
-QSqlQuery* DbManager::selectGroups(int favorite)
+DbCursor DbManager::selectGroups(int favorite)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare("SELECT * FROM groups WHERE (favorite = :favorite OR :favorite = 0) ORDER BY group_title");
+    DbCursor select = this->prepare("SELECT * FROM groups WHERE (favorite = :favorite OR :favorite = 0) ORDER BY group_title");
     select->bindValue(":favorite", favorite);
 
     if ( ! select->exec() ) {
@@ -925,11 +1578,10 @@ QSqlQuery* DbManager::selectGroups(int favorite)
     return select;
 }
 
-QSqlQuery* DbManager::selectEPGChannels(const QString& region)
+DbCursor DbManager::selectEPGChannels(const QString& region)
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare(QString("select * from program where channel like '%%1%' group by channel").arg(region));
+    DbCursor select = this->prepare("select * from program where channel like :region group by channel");
+    select->bindValue(":region", QString("%%1%").arg(region));
 
     if ( ! select->exec() ) {
         qDebug() << "selectEPGChannels" << select->lastError();
@@ -942,15 +1594,14 @@ int DbManager::insertINI(const QString& key, const QString& text)
 {
     int id = 0;
 
-    QSqlQuery query;
-    query.prepare("INSERT INTO ini (key, text) VALUES (:key, :text)");
-    query.bindValue(":key", key);
-    query.bindValue(":text", text);
+    DbCursor query = this->prepare("INSERT INTO ini (key, text) VALUES (:key, :text)");
+    query->bindValue(":key", key);
+    query->bindValue(":text", text);
 
-    if ( query.exec() ) {
-        id = query.lastInsertId().toInt();
+    if ( query->exec() ) {
+        id = query->lastInsertId().toInt();
     } else {
-        qDebug() << "insertINI" << query.lastError();
+        qDebug() << "insertINI" << query->lastError();
     }
 
     return id;
@@ -960,7 +1611,7 @@ bool DbManager::removeINI()
 {
     bool success = false;
 
-    QSqlQuery query;
+    QSqlQuery query(this->database());
 
     if ( query.exec("DELETE FROM ini") ) {
         success = true;
@@ -971,11 +1622,9 @@ bool DbManager::removeINI()
     return success;
 }
 
-QSqlQuery* DbManager::selectINI()
+DbCursor DbManager::selectINI()
 {
-    QSqlQuery *select = new QSqlQuery();
-
-    select->prepare(QString("select * from ini") );
+    DbCursor select = this->prepare(QString("select * from ini"));
 
     if ( ! select->exec() ) {
         qDebug() << "selectINI" << select->lastError();
@@ -2,22 +2,113 @@
 #define DBMANAGER_H
 
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QVariant>
 
+#include <vector>
+
+// a prepared statement of the statement cache, busy while a cursor uses it
+struct DbStatement
+{
+    QSqlQuery query;
+    bool      busy;
+
+    explicit DbStatement(const QSqlDatabase& db) : query(db), busy(false) {}
+};
+
+// result of a DbManager query, gives the statement back to the cache when it goes out of scope
+class DbCursor
+{
+public:
+    DbCursor();
+    DbCursor(DbStatement* statement, bool owned);
+    DbCursor(DbCursor&& other);
+    DbCursor& operator=(DbCursor&& other);
+    ~DbCursor();
+
+    QSqlQuery* operator->() const { return &m_statement->query; }
+    QSqlQuery& operator*() const { return m_statement->query; }
+
+private:
+    DbCursor(const DbCursor&) = delete;
+    DbCursor& operator=(const DbCursor&) = delete;
+
+    void release();
+
+    DbStatement* m_statement;
+    bool         m_owned;
+};
+
+// typed rows of the selects below, filled from explicit column lists
+
+struct ExtinfRow
+{
+    int     id = 0;
+    QString tvg_name;
+    QString tvg_id;
+    int     group_id = 0;
+    QString tvg_logo;
+    QString url;
+    int     state = 0;
+    QString group_title;
+    int     group_favorite = 0;
+    int     used = 0;
+};
+
+struct PlsItemRow
+{
+    int     id = 0;
+    int     pls_id = 0;
+    int     extinf_id = 0;
+    int     pls_pos = 0;
+    int     favorite = 0;
+    QString tvg_name;
+    QString tvg_id;
+    QString tvg_logo;
+    QString url;
+};
+
+struct ProgramRow
+{
+    qint64  start = 0;
+    qint64  stop = 0;
+    QString channel;
+    QString title;
+};
+
+struct DbConnection;
+
+// every thread using a DbManager gets a connection of its own, opened with the
+// same pragmas on first use and closed when the thread ends, so the importers
+// and other workers can query the database without going through the gui thread
 class DbManager
 {
 public:
+    // WAL lets the gui read while an import writes on another connection,
+    // Memory is the old unsafe setting, kept for comparison in the benchmark
+    enum Journal { JournalWal, JournalMemory };
+
     DbManager();
 
     ~DbManager();
 
-    bool open(const QString& path);
+    void setJournal(Journal journal);
+    bool open(const QString& path, const QString& connectionName = QLatin1String(QSqlDatabase::defaultConnection));
     bool isOpen();
+    QSqlDatabase database();
+    bool checkpoint();
 
     bool createTable();
 
+    bool transaction();
+    bool commit();
+    bool rollback();
+
     int  insertEXTINF(const QString&, const QString&, int, const QString&, const QString&);
     bool removeAllEXTINFs();
-    bool removeObsoleteEXTINFs();
+    bool removeObsoleteEXTINFs(int);
+    int  countObsoleteEXTINFs(int);
     bool updateEXTINF_byRef(int, const QString&, int, const QString&, int);
     bool updateEXTINF_tvg_logo_byRef(int, const QString&);
     bool updateEXTINF_tvg_id_byRef(int, const QString&);
@@ -25,18 +116,22 @@ public:
     bool updateEXTINF_url_byRef(int, const QString&);
     bool updateEXTINF_tvg_logo_by_tvg_name(const QString&, const QString&);
 
-    bool deactivateEXTINFs();
-    QSqlQuery* selectEXTINF(const QString&, const QString&, const QString&, int);
-    QSqlQuery* selectEXTINF_group_titles(int);
-    QSqlQuery* selectEXTINF_byUrl(const QString&);
-    QSqlQuery* countEXTINF_byState();
+    int  insertImportRun();
+    bool finishImportRun(int, int);
+
+    bool selectEXTINF(const QString&, const QString&, const QString&, int, std::vector<ExtinfRow>&);
+    DbCursor selectEXTINF_group_titles(int);
+    DbCursor selectEXTINF_byUrl(const QString&);
+    DbCursor selectEXTINF_urls();
+    DbCursor selectEXTINF_tvg_ids();
+    DbCursor countEXTINF_byState();
 
     int addGroup(const QString&);
     bool updateGroup(int, const QString&, int);
     bool updateGroupFavorite(int, int);
 
-    QSqlQuery* selectGroup_byTitle(const QString&);
-    QSqlQuery* selectGroups(int favorite);
+    DbCursor selectGroup_byTitle(const QString&);
+    DbCursor selectGroups(int favorite);
 
     bool updatePLS(int, const QString &);
     bool updatePLS_favorite(int, int);
@@ -48,32 +143,52 @@ public:
 
     int insertPLS(const QString &, int);
     bool removePLS(int);
-    QSqlQuery* selectPLS(int);
-    QSqlQuery* selectPLS_by_id(int);
-    QSqlQuery* selectPLS_by_pls_name(const QString& );
+    DbCursor selectPLS(int);
+    DbCursor selectPLS_by_id(int);
+    DbCursor selectPLS_by_pls_name(const QString& );
 
-    QSqlQuery* selectEXTINF_byRef(int);
-    QSqlQuery* selectPLS_Items_by_extinf_id(int);
-    QSqlQuery* selectPLS_Items_by_key(int, int);
+    bool selectEXTINF_byRef(int, ExtinfRow&);
+    DbCursor selectPLS_Items_by_extinf_id(int);
+    DbCursor selectPLS_Items_by_key(int, int);
+    DbCursor selectPLS_Items_keys();
 
     int insertPLS_Item(int, int, int);
-    QSqlQuery* selectPLS_Items(int, const QString&, int);
+    bool selectPLS_Items(int, const QString&, int, std::vector<PlsItemRow>&);
+    DbCursor selectPLS_Items_m3u(int);
     bool removePLS_Item(int);
     bool removePLS_Items(int);
 
     bool removeOldPrograms();
-    bool addProgram(const QString&, const QString&, const QString&, const QString&, const QString&);
-    QSqlQuery* selectActualProgramData(const QString &);
-    QSqlQuery* selectProgramData(const QString &);
+    bool selectActualProgramData_byPls(int, std::vector<ProgramRow>&);
+    DbCursor selectProgramTimeline(const QString &);
+    DbCursor selectEpgText(qint64);
 
-    QSqlQuery* selectEPGChannels(const QString&);
+    static bool compressEpgText(const QString&, bool);
+    static qint64 epgTextId(const QString&, bool);
+    static QVariant packEpgText(const QString&, bool);
+    static QString unpackEpgText(const QVariant&, bool);
 
-    QSqlQuery* selectINI();
+    DbCursor selectEPGChannels(const QString&);
+
+    DbCursor selectINI();
     int insertINI(const QString&, const QString&);
     bool removeINI();
 
 private:
-    QSqlDatabase m_db;
+    QString columnType(const QString&, const QString&);
+    bool columnExists(const QString&, const QString&);
+    bool addColumn(const QString&, const QString&, const QString&);
+    bool hasStationIndex();
+
+    DbConnection* connection();
+    bool openConnection(QSqlDatabase&);
+    void closeConnection();
+
+    DbCursor prepare(const QString&, bool forwardOnly = false);
+
+    QString      m_path;
+    QString      m_key;
+    Journal      m_journal;
 };
 
 #endif // DBMANAGER_H
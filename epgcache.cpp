@@ -0,0 +1,102 @@
+#include "epgcache.h"
+
+#include <QSqlQuery>
+#include <QVariant>
+
+#include <algorithm>
+
+static bool startsBefore(qint64 now, const EpgEntry &entry)
+{
+    return now < entry.start;
+}
+
+EpgCache::EpgCache(DbManager &db) :
+    m_db(db)
+{
+}
+
+void EpgCache::invalidate()
+{
+    m_channels.clear();
+    m_texts.clear();
+}
+
+QString EpgCache::text(qint64 id)
+{
+    if ( id == 0 ) {
+        return QString();
+    }
+
+    QHash<qint64, QString>::const_iterator it = m_texts.constFind(id);
+
+    if ( it != m_texts.constEnd() ) {
+        return it.value();
+    }
+
+    QString text;
+    DbCursor select = m_db.selectEpgText(id);
+
+    if ( select->next() ) {
+        text = DbManager::unpackEpgText(select->value(0), select->value(1).toInt() != 0);
+    }
+
+    m_texts.insert(id, text);
+
+    return text;
+}
+
+const QVector<EpgEntry> &EpgCache::timeline(const QString &channel)
+{
+    QHash<QString, QVector<EpgEntry> >::iterator it = m_channels.find(channel);
+
+    if ( it != m_channels.end() ) {
+        return it.value();
+    }
+
+    QVector<EpgEntry> entries;
+    DbCursor select = m_db.selectProgramTimeline(channel);
+
+    while ( select->next() ) {
+        EpgEntry entry;
+        entry.start = select->value(0).toLongLong();
+        entry.stop = select->value(1).toLongLong();
+        entry.title = select->value(2).toLongLong();
+        entry.desc = select->value(3).toLongLong();
+        entries.append(entry);
+    }
+
+    entries.squeeze();
+
+    return m_channels.insert(channel, entries).value();
+}
+
+int EpgCache::position(const QVector<EpgEntry> &entries, qint64 now) const
+{
+    // the first entry starting after now
+    return int(std::upper_bound(entries.constBegin(), entries.constEnd(), now, startsBefore) - entries.constBegin());
+}
+
+const EpgEntry *EpgCache::actual(const QString &channel, qint64 now)
+{
+    const QVector<EpgEntry> &entries = this->timeline(channel);
+    const int pos = this->position(entries, now) - 1;
+
+    if ( pos >= 0 && entries.at(pos).stop > now ) {
+        return &entries.at(pos);
+    }
+
+    return nullptr;
+}
+
+QVector<EpgEntry> EpgCache::rest(const QString &channel, qint64 now)
+{
+    const QVector<EpgEntry> &entries = this->timeline(channel);
+    int pos = this->position(entries, now);
+
+    // include the running programme
+    if ( pos > 0 && entries.at(pos - 1).stop > now ) {
+        pos--;
+    }
+
+    return entries.mid(pos);
+}
@@ -0,0 +1,44 @@
+#ifndef EPGCACHE_H
+#define EPGCACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "dbmanager.h"
+
+struct EpgEntry
+{
+    qint64 start;
+    qint64 stop;
+    qint64 title;
+    qint64 desc;
+};
+
+// The EPG of every channel as sorted array, loaded lazily from the program
+// table on the first lookup of the channel. The entries only hold the ids
+// of their epg_text rows, text() loads a text on first use and keeps it.
+// invalidate() after an import.
+
+class EpgCache
+{
+public:
+    explicit EpgCache(DbManager &db);
+
+    void invalidate();
+
+    const EpgEntry *actual(const QString &channel, qint64 now);
+    QVector<EpgEntry> rest(const QString &channel, qint64 now);
+
+    QString text(qint64 id);
+
+private:
+    const QVector<EpgEntry> &timeline(const QString &channel);
+    int position(const QVector<EpgEntry> &entries, qint64 now) const;
+
+    DbManager                          &m_db;
+    QHash<QString, QVector<EpgEntry> >  m_channels;
+    QHash<qint64, QString>              m_texts;
+};
+
+#endif // EPGCACHE_H
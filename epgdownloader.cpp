@@ -0,0 +1,200 @@
+#include "epgdownloader.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+EpgDownloader::EpgDownloader(const QUrl &url, const QString &filename, QObject *parent) :
+    QObject(parent),
+    m_downloader(url, filename, this),
+    m_parser(nullptr),
+    m_capacity(0),
+    m_released(false),
+    m_channels(nullptr),
+    m_bytesReceived(0),
+    m_bytesTotal(0)
+{
+    connect(&m_downloader, SIGNAL(received(QByteArray)), this, SLOT(streamReceived(QByteArray)));
+    connect(&m_downloader, SIGNAL(progress(qint64,qint64)), this, SLOT(streamProgress(qint64,qint64)));
+    connect(&m_downloader, SIGNAL(finished(bool,QString)), this, SLOT(streamFinished(bool,QString)));
+}
+
+EpgDownloader::~EpgDownloader()
+{
+    delete m_parser;
+}
+
+void EpgDownloader::setChannelFilter(const QSet<QString> *channels)
+{
+    m_channels = channels;
+}
+
+void EpgDownloader::setCapacity(int programs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_capacity = programs;
+}
+
+// thread safe, a waiting parser goes on so that abort() gets through
+void EpgDownloader::release()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_released = true;
+
+    m_taken.wakeAll();
+}
+
+void EpgDownloader::start()
+{
+    delete m_parser;
+    m_parser = new EpgStreamParser(m_channels);
+
+    m_mutex.lock();
+    m_result = EpgChunkResult();
+    m_mutex.unlock();
+
+    m_error.clear();
+
+    // the first bytes tell whether the reply is compressed
+    m_decompressor.begin(StreamDecompressor::Detect);
+
+    m_downloader.start();
+}
+
+void EpgDownloader::abort()
+{
+    m_downloader.abort();
+}
+
+QVector<EpgProgram> EpgDownloader::takePrograms()
+{
+    QVector<EpgProgram> programs;
+
+    QMutexLocker locker(&m_mutex);
+
+    programs.swap(m_result.programs);
+
+    m_taken.wakeAll();
+
+    return programs;
+}
+
+int EpgDownloader::skipped() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_result.skipped;
+}
+
+qint64 EpgDownloader::bytesReceived() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_bytesReceived;
+}
+
+qint64 EpgDownloader::bytesTotal() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_bytesTotal;
+}
+
+QString EpgDownloader::getFilename() const
+{
+    return m_downloader.getFilename();
+}
+
+void EpgDownloader::streamReceived(const QByteArray &data)
+{
+    if ( ! m_error.isEmpty() ) {
+        return;
+    }
+
+    m_xml.clear();
+
+    if ( ! m_decompressor.decompress(data.constData(), data.size(), m_xml) ) {
+        m_error = m_decompressor.errorString();
+        m_downloader.abort();
+        return;
+    }
+
+    EpgChunkResult result;
+
+    m_parser->addData(m_xml);
+    m_parser->parse(result);
+
+    this->append(result);
+
+    // no use in downloading the rest of a broken document
+    if ( ! result.error.isEmpty() ) {
+        m_error = result.error;
+        m_downloader.abort();
+    }
+}
+
+void EpgDownloader::append(const EpgChunkResult &result)
+{
+    // parsed without the lock, the writer only waits for the hand over
+    m_mutex.lock();
+
+    // received() for the queued programmes is already on its way
+    while ( m_capacity > 0 && ! m_released && m_result.programs.size() >= m_capacity ) {
+        m_taken.wait(&m_mutex);
+    }
+
+    if ( m_result.programs.isEmpty() ) {
+        m_result.programs = result.programs;
+    } else {
+        m_result.programs += result.programs;
+    }
+
+    m_result.skipped += result.skipped;
+
+    m_mutex.unlock();
+
+    if ( ! result.programs.isEmpty() ) {
+        emit received();
+    }
+}
+
+void EpgDownloader::streamProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_bytesReceived = bytesReceived;
+    m_bytesTotal = bytesTotal > 0 ? bytesTotal : 0;
+}
+
+void EpgDownloader::streamFinished(bool success, const QString &error)
+{
+    if ( success && m_error.isEmpty() ) {
+
+        m_xml.clear();
+
+        if ( m_decompressor.finish(m_xml) ) {
+
+            EpgChunkResult result;
+
+            m_parser->addData(m_xml);
+            m_parser->finish(result);
+
+            this->append(result);
+
+            m_error = result.error;
+
+        } else {
+            m_error = m_decompressor.errorString();
+        }
+
+    } else if ( m_error.isEmpty() ) {
+        m_error = error;
+    }
+
+    if ( ! m_error.isEmpty() ) {
+        qDebug() << "EpgDownloader" << m_downloader.getFilename() << m_error;
+    }
+
+    emit finished(m_error.isEmpty(), m_error);
+}
@@ -0,0 +1,71 @@
+#ifndef EPGDOWNLOADER_H
+#define EPGDOWNLOADER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSet>
+#include <QUrl>
+
+#include "epgparser.h"
+#include "streamdecompressor.h"
+#include "streamdownloader.h"
+
+// Downloads an XMLTV url and parses it while the reply is still coming in,
+// gzip and xz replies are unpacked on the way. received() announces new
+// programmes, takePrograms() hands them over. The raw reply is written to
+// the file as well. The downloader may run on a thread of its own, the
+// programmes and counters are handed over under a mutex then. With a
+// capacity set the parsing thread waits for takePrograms() as soon as that
+// many programmes are queued, the reply is not read meanwhile.
+
+class EpgDownloader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EpgDownloader(const QUrl &url, const QString &filename, QObject *parent = nullptr);
+    virtual ~EpgDownloader();
+
+    void setChannelFilter(const QSet<QString> *channels);
+    void setCapacity(int programs);
+    void release();
+
+    QVector<EpgProgram> takePrograms();
+
+    int     skipped() const;
+    qint64  bytesReceived() const;
+    qint64  bytesTotal() const;
+    QString getFilename() const;
+
+public slots:
+    void start();
+    void abort();
+
+signals:
+    void received();
+    void finished(bool success, const QString &error);
+
+private slots:
+    void streamReceived(const QByteArray &data);
+    void streamProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void streamFinished(bool success, const QString &error);
+
+private:
+    void append(const EpgChunkResult &result);
+
+    StreamDownloader     m_downloader;
+    StreamDecompressor   m_decompressor;
+    EpgStreamParser     *m_parser;
+    EpgChunkResult       m_result;
+    mutable QMutex       m_mutex;
+    QWaitCondition       m_taken;
+    int                  m_capacity;
+    bool                 m_released;
+    QByteArray           m_xml;
+    const QSet<QString> *m_channels;
+    QString              m_error;
+    qint64               m_bytesReceived;
+    qint64               m_bytesTotal;
+};
+
+#endif // EPGDOWNLOADER_H
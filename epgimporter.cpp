@@ -0,0 +1,153 @@
+#include "epgimporter.h"
+
+#include <QDebug>
+#include <QVariant>
+#include <QSqlError>
+
+EpgImporter::EpgImporter(DbManager &db, int chunkSize) :
+    m_db(db),
+    m_chunkSize(chunkSize),
+    m_active(false),
+    m_programs(0),
+    m_duplicates(0),
+    m_chunkPrograms(0)
+{
+}
+
+EpgImporter::~EpgImporter()
+{
+    if ( m_active ) {
+        this->finish();
+    }
+}
+
+bool EpgImporter::begin()
+{
+    m_programs = m_duplicates = m_chunkPrograms = 0;
+    m_timer.start();
+
+    m_insertProgram = QSqlQuery(m_db.database());
+    m_insertProgram.prepare("INSERT OR IGNORE INTO program (start, stop, channel, title_id, desc_id ) VALUES (:start, :stop, :channel, :title_id, :desc_id)");
+
+    m_insertText = QSqlQuery(m_db.database());
+    m_insertText.prepare("INSERT OR IGNORE INTO epg_text (id, compressed, text) VALUES (:id, :compressed, :text)");
+
+    m_textIds.clear();
+
+    m_active = m_db.transaction();
+
+    return m_active;
+}
+
+bool EpgImporter::addProgram(qint64 start, qint64 stop, const QString& channel,
+                             const QString& title, const QString& desc)
+{
+    bool success = true;
+
+    m_insertProgram.bindValue(":start", start);
+    m_insertProgram.bindValue(":stop", stop);
+    m_insertProgram.bindValue(":channel", channel);
+    m_insertProgram.bindValue(":title_id", this->textId(title, false));
+    m_insertProgram.bindValue(":desc_id", this->textId(desc, true));
+
+    if ( ! m_insertProgram.exec() ) {
+        qDebug() << "insertProgram" << m_insertProgram.lastError() << channel << start;
+        success = false;
+    } else if ( m_insertProgram.numRowsAffected() == 0 ) {
+        // program already there...
+        m_duplicates++;
+    } else {
+        m_programs++;
+    }
+
+    if ( ++m_chunkPrograms >= m_chunkSize ) {
+        success = this->nextChunk() && success;
+    }
+
+    return success;
+}
+
+bool EpgImporter::finish()
+{
+    bool success = true;
+
+    if ( m_active ) {
+        success = m_db.commit();
+        m_active = false;
+    }
+
+    m_db.checkpoint();
+
+    m_insertProgram.finish();
+    m_insertText.finish();
+
+    qDebug() << "EpgImporter" << m_textIds.size() << "distinct texts";
+
+    qDebug() << "EpgImporter" << m_programs << "programs," << m_duplicates << "duplicates in" << this->elapsed() << "ms";
+
+    return success;
+}
+
+int EpgImporter::programs() const
+{
+    return m_programs;
+}
+
+int EpgImporter::duplicates() const
+{
+    return m_duplicates;
+}
+
+qint64 EpgImporter::elapsed() const
+{
+    return m_timer.isValid() ? m_timer.elapsed() : 0;
+}
+
+double EpgImporter::programsPerSecond() const
+{
+    const qint64 msecs = this->elapsed();
+
+    return msecs > 0 ? ( m_programs + m_duplicates ) * 1000.0 / msecs : 0.0;
+}
+
+qint64 EpgImporter::textId(const QString& text, bool compress)
+{
+    if ( text.isEmpty() ) {
+        return 0;
+    }
+
+    const bool   compressed = DbManager::compressEpgText(text, compress);
+    const qint64 id = DbManager::epgTextId(text, compressed);
+
+    // every text is written once per import, repeats only cost the hash
+    if ( m_textIds.contains(id) ) {
+        return id;
+    }
+
+    m_insertText.bindValue(":id", id);
+    m_insertText.bindValue(":compressed", compressed ? 1 : 0);
+    m_insertText.bindValue(":text", DbManager::packEpgText(text, compressed));
+
+    if ( ! m_insertText.exec() ) {
+        qDebug() << "insertText" << m_insertText.lastError();
+        return 0;
+    }
+
+    m_textIds.insert(id);
+
+    return id;
+}
+
+bool EpgImporter::nextChunk()
+{
+    m_chunkPrograms = 0;
+
+    if ( ! m_db.commit() ) {
+        m_active = false;
+        return false;
+    }
+
+    m_active = m_db.transaction();
+
+    return m_active;
+}
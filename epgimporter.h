@@ -0,0 +1,50 @@
+#ifndef EPGIMPORTER_H
+#define EPGIMPORTER_H
+
+#include <QSqlQuery>
+#include <QElapsedTimer>
+#include <QSet>
+
+#include "dbmanager.h"
+
+// Writes the programmes of one XMLTV file into the database through a single
+// prepared INSERT OR IGNORE, split into chunked transactions. Programmes that
+// are already there are counted as duplicates instead of failing the insert.
+// Titles and descriptions go to epg_text once per text, long descriptions
+// zlib compressed, the programme rows only carry their ids.
+
+class EpgImporter
+{
+public:
+    explicit EpgImporter(DbManager &db, int chunkSize = 5000);
+    ~EpgImporter();
+
+    bool begin();
+    bool addProgram(qint64 start, qint64 stop, const QString& channel,
+                    const QString& title, const QString& desc);
+    bool finish();
+
+    int programs() const;
+    int duplicates() const;
+    qint64 elapsed() const;
+    double programsPerSecond() const;
+
+private:
+    bool nextChunk();
+    qint64 textId(const QString& text, bool compress);
+
+    DbManager     &m_db;
+    int           m_chunkSize;
+    bool          m_active;
+
+    QSqlQuery     m_insertProgram;
+    QSqlQuery     m_insertText;
+    QSet<qint64>  m_textIds;
+
+    int           m_programs;
+    int           m_duplicates;
+    int           m_chunkPrograms;
+    QElapsedTimer m_timer;
+};
+
+#endif // EPGIMPORTER_H
@@ -0,0 +1,283 @@
+#include "epgparser.h"
+
+#include <QDateTime>
+#include <QXmlStreamReader>
+
+#include <cstring>
+
+EpgParser::EpgParser(const char *data, qint64 size) :
+    m_data(data),
+    m_size(size),
+    m_channels(nullptr)
+{
+    // every chunk gets the declaration of the file, it may name the encoding
+    const qint64 end = this->find("?>", 0, qMin<qint64>(size, 512));
+
+    if ( size >= 5 && memcmp(data, "<?xml", 5) == 0 && end >= 0 ) {
+        m_header = QByteArray(data, int(end + 2));
+    }
+
+    m_header += "<tv>";
+}
+
+void EpgParser::setChannelFilter(const QSet<QString> *channels)
+{
+    m_channels = channels;
+}
+
+qint64 EpgParser::find(const char *text, qint64 from, qint64 to) const
+{
+    const size_t length = strlen(text);
+
+    for ( qint64 pos = from; pos + qint64(length) <= to; pos++ ) {
+
+        const char *c = static_cast<const char *>(memchr(m_data + pos, text[0], size_t(to - pos)));
+
+        if ( c == nullptr ) {
+            break;
+        }
+
+        pos = c - m_data;
+
+        if ( pos + qint64(length) <= to && memcmp(c, text, length) == 0 ) {
+            return pos;
+        }
+    }
+
+    return -1;
+}
+
+qint64 EpgParser::findLast(const char *text) const
+{
+    const size_t length = strlen(text);
+
+    for ( qint64 pos = m_size - qint64(length); pos >= 0; pos-- ) {
+        if ( m_data[pos] == text[0] && memcmp(m_data + pos, text, length) == 0 ) {
+            return pos;
+        }
+    }
+
+    return -1;
+}
+
+QVector<EpgChunk> EpgParser::split(int chunks) const
+{
+    QVector<EpgChunk> result;
+
+    const qint64 first = this->find("<programme", 0, m_size);
+    const qint64 last = this->findLast("</programme>");
+
+    if ( first < 0 || last < first ) {
+        return result;
+    }
+
+    const qint64 end = last + qint64(strlen("</programme>"));
+    const qint64 step = qMax<qint64>(1, ( end - first ) / qMax(1, chunks));
+
+    qint64 begin = first;
+
+    while ( begin < end ) {
+
+        qint64 next = begin + step < end ? this->find("<programme", begin + step, end) : -1;
+
+        if ( next < 0 ) {
+            next = end;
+        }
+
+        EpgChunk chunk;
+        chunk.data = m_data + begin;
+        chunk.size = next - begin;
+        result.append(chunk);
+
+        begin = next;
+    }
+
+    return result;
+}
+
+static int digits(const QStringRef &text, int pos, int count)
+{
+    int value = 0;
+
+    for ( int i = pos; i < pos + count; i++ ) {
+
+        if ( i >= text.size() || ! text.at(i).isDigit() ) {
+            return -1;
+        }
+
+        value = value * 10 + text.at(i).digitValue();
+    }
+
+    return value;
+}
+
+qint64 EpgParser::toEpoch(const QStringRef &time)
+{
+    // YYYYMMDDhhmmss +zzzz, seconds and offset are optional
+    const int year = digits(time, 0, 4);
+    const int month = digits(time, 4, 2);
+    const int day = digits(time, 6, 2);
+    const int hour = digits(time, 8, 2);
+    const int minute = digits(time, 10, 2);
+    const int second = qMax(0, digits(time, 12, 2));
+
+    if ( year < 0 || month < 0 || day < 0 || hour < 0 || minute < 0 ) {
+        return 0;
+    }
+
+    const QDateTime utc(QDate(year, month, day), QTime(hour, minute, second), Qt::UTC);
+
+    if ( ! utc.isValid() ) {
+        return 0;
+    }
+
+    qint64 epoch = utc.toSecsSinceEpoch();
+
+    const int sign = time.indexOf('+') >= 0 ? time.indexOf('+') : time.indexOf('-');
+
+    if ( sign >= 0 ) {
+        const int hours = digits(time, sign + 1, 2);
+        const int minutes = digits(time, sign + 3, 2);
+
+        if ( hours >= 0 && minutes >= 0 ) {
+            const int offset = hours * 3600 + minutes * 60;
+            epoch += time.at(sign) == '+' ? -offset : offset;
+        }
+    }
+
+    return epoch;
+}
+
+EpgChunkResult EpgParser::parseChunk(const EpgChunk &chunk) const
+{
+    EpgChunkResult  result;
+    EpgStreamParser stream(m_channels);
+
+    QByteArray xml;
+    xml.reserve(m_header.size() + int(chunk.size) + 5);
+    xml += m_header;
+    xml.append(chunk.data, int(chunk.size));
+    xml += "</tv>";
+
+    stream.addData(xml);
+    stream.finish(result);
+
+    return result;
+}
+
+EpgStreamParser::EpgStreamParser(const QSet<QString> *channels) :
+    m_text(nullptr),
+    m_skip(false),
+    m_complete(false),
+    m_channels(channels)
+{
+}
+
+void EpgStreamParser::addData(const QByteArray &data)
+{
+    m_reader.addData(data);
+}
+
+void EpgStreamParser::parse(EpgChunkResult &result)
+{
+    // the text is collected token by token, readElementText() would lose
+    // the part before a premature end of the data
+    for ( ;; ) {
+
+        if ( m_reader.tokenType() == QXmlStreamReader::EndDocument ) {
+            break;
+        }
+
+        if ( m_reader.hasError() && m_reader.error() != QXmlStreamReader::PrematureEndOfDocumentError ) {
+            break;
+        }
+
+        // after a premature end readNext() resumes with the added data
+        const QXmlStreamReader::TokenType token = m_reader.readNext();
+
+        if ( token == QXmlStreamReader::StartElement ) {
+
+            if ( m_skip ) {
+                continue;
+            }
+
+            if ( m_reader.name() == "programme" ) {
+
+                const QXmlStreamAttributes attributes = m_reader.attributes();
+
+                if ( m_channels != nullptr ) {
+
+                    // look up the channel without copying it into a string
+                    const QStringRef channel = attributes.value("channel");
+
+                    if ( ! m_channels->contains(QString::fromRawData(channel.unicode(), channel.size())) ) {
+
+                        result.skipped++;
+
+                        // an element cut short can't be skipped in one go
+                        if ( m_complete ) {
+                            m_reader.skipCurrentElement();
+                        } else {
+                            m_skip = true;
+                        }
+                        continue;
+                    }
+                }
+
+                m_program.start = EpgParser::toEpoch(attributes.value("start"));
+                m_program.stop = EpgParser::toEpoch(attributes.value("stop"));
+                m_program.channel = attributes.value("channel").toString();
+            } else if ( m_reader.name() == "title" ) {
+                m_text = &m_program.title;
+                m_text->clear();
+            } else if ( m_reader.name() == "desc" ) {
+                m_text = &m_program.desc;
+                m_text->clear();
+            }
+
+        } else if ( token == QXmlStreamReader::Characters ) {
+
+            if ( m_text != nullptr ) {
+                m_text->append(m_reader.text());
+            }
+
+        } else if ( token == QXmlStreamReader::EndElement ) {
+
+            m_text = nullptr;
+
+            if ( m_reader.name() == "programme" ) {
+
+                if ( ! m_skip ) {
+                    result.programs.append(m_program);
+                }
+
+                m_program = EpgProgram();
+                m_skip = false;
+            }
+
+        } else if ( token == QXmlStreamReader::Invalid ) {
+
+            // waits for more data
+            if ( m_reader.error() == QXmlStreamReader::PrematureEndOfDocumentError ) {
+                break;
+            }
+
+            if ( result.error.isEmpty() ) {
+                result.error = m_reader.errorString();
+            }
+
+            break;
+        }
+    }
+}
+
+void EpgStreamParser::finish(EpgChunkResult &result)
+{
+    m_complete = true;
+
+    this->parse(result);
+
+    if ( m_reader.error() == QXmlStreamReader::PrematureEndOfDocumentError && result.error.isEmpty() ) {
+        result.error = m_reader.errorString();
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef EPGPARSER_H
+#define EPGPARSER_H
+
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <QXmlStreamReader>
+
+struct EpgProgram
+{
+    qint64  start;
+    qint64  stop;
+    QString channel;
+    QString title;
+    QString desc;
+
+    EpgProgram() : start(0), stop(0) {}
+};
+
+struct EpgChunk
+{
+    const char *data;
+    qint64      size;
+};
+
+struct EpgChunkResult
+{
+    QVector<EpgProgram> programs;
+    QString             error;
+    int                 skipped;
+
+    EpgChunkResult() : skipped(0) {}
+};
+
+// Reads <programme> elements from XMLTV data that arrives piece by piece.
+// parse() returns the programmes complete so far and keeps the unfinished
+// one, a document cut short is only an error once finish() is called.
+// A programme of a filtered channel may still be incomplete while data
+// comes in, its child tokens are read and dropped then. Once finish() has
+// all the data, skipCurrentElement() steps over it instead.
+
+class EpgStreamParser
+{
+public:
+    explicit EpgStreamParser(const QSet<QString> *channels = nullptr);
+
+    void addData(const QByteArray &data);
+    void parse(EpgChunkResult &result);
+    void finish(EpgChunkResult &result);
+
+private:
+    QXmlStreamReader     m_reader;
+    EpgProgram           m_program;
+    QString             *m_text;
+    bool                 m_skip;
+    bool                 m_complete;
+    const QSet<QString> *m_channels;
+};
+
+// XMLTV files are a flat sequence of <programme> elements. split() cuts the
+// (mapped) file on <programme boundaries, every chunk is parsed on its own
+// by parseChunk() so the chunks can run on a thread pool. With a channel
+// filter the programmes of all other channels are skipped with
+// skipCurrentElement(), their titles and descriptions are never copied.
+
+class EpgParser
+{
+public:
+    EpgParser(const char *data, qint64 size);
+
+    void setChannelFilter(const QSet<QString> *channels);
+
+    QVector<EpgChunk> split(int chunks) const;
+
+    EpgChunkResult parseChunk(const EpgChunk &chunk) const;
+
+    static qint64 toEpoch(const QStringRef &time);
+
+private:
+    qint64 find(const char *text, qint64 from, qint64 to) const;
+    qint64 findLast(const char *text) const;
+
+    const char *m_data;
+    qint64      m_size;
+    QByteArray  m_header;
+
+    const QSet<QString> *m_channels;
+};
+
+#endif // EPGPARSER_H
@@ -0,0 +1,215 @@
+#include "headlessrunner.h"
+
+#include <QDateTime>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QUrl>
+
+#include "importworker.h"
+#include "m3uexporter.h"
+
+HeadlessRunner::HeadlessRunner(const QString &databaseFile, QObject *parent) :
+    QObject(parent),
+    m_databaseFile(databaseFile),
+    m_dataPath(QFileInfo(databaseFile).absolutePath()),
+    m_out(stdout),
+    m_success(false),
+    m_failed(false),
+    m_finished(false),
+    m_epgFilter(false)
+{
+}
+
+void HeadlessRunner::setEpgChannelFilter(bool enabled, const QStringList &allowList)
+{
+    m_epgFilter = enabled;
+    m_epgAllowList = allowList;
+}
+
+bool HeadlessRunner::isRemote(const QString &source)
+{
+    const QString scheme = QUrl(source).scheme();
+
+    return scheme == "http" || scheme == "https" || scheme == "ftp";
+}
+
+QString HeadlessRunner::timestampedFile(const QString &pattern) const
+{
+    const QString timestamp = QDateTime::currentDateTime().toString(QLatin1String("yyyyMMddhhmmss"));
+
+    return m_dataPath + "/" + pattern.arg(timestamp);
+}
+
+bool HeadlessRunner::importM3u(const QString &source)
+{
+    ImportWorker worker(m_databaseFile);
+    QEventLoop   loop;
+
+    connect(&worker, SIGNAL(m3uDownloadFailed(QString)), this, SLOT(m3uDownloadFailed(QString)));
+    connect(&worker, SIGNAL(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)), this, SLOT(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)));
+    connect(&worker, SIGNAL(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)), &loop, SLOT(quit()));
+
+    m_success = m_failed = m_finished = false;
+
+    m_out << "import m3u " << source << "\n";
+    m_out.flush();
+
+    if ( isRemote(source) ) {
+        worker.importM3uUrl(source, this->timestampedFile("iptv-%1.m3u"));
+    } else {
+        worker.importM3u(source);
+    }
+
+    if ( ! m_finished ) {
+        loop.exec();
+    }
+
+    return m_success;
+}
+
+bool HeadlessRunner::importEpg(const QString &source, const QString &hourCorrection)
+{
+    ImportWorker worker(m_databaseFile);
+    QEventLoop   loop;
+
+    connect(&worker, SIGNAL(epgImportFinished(int,int,double,QString,bool)), this, SLOT(epgImportFinished(int,int,double,QString,bool)));
+    connect(&worker, SIGNAL(epgImportFinished(int,int,double,QString,bool)), &loop, SLOT(quit()));
+
+    m_success = m_finished = false;
+
+    m_out << "import epg " << source << "\n";
+    m_out.flush();
+
+    worker.setEpgChannelFilter(m_epgFilter, m_epgAllowList);
+
+    // a download is parsed and imported while it is running
+    if ( isRemote(source) ) {
+        worker.importEpgUrl(source, this->timestampedFile("epg-%1.xml"), hourCorrection);
+    } else {
+        worker.importEpg(source, hourCorrection);
+    }
+
+    if ( ! m_finished ) {
+        loop.exec();
+    }
+
+    return m_success;
+}
+
+bool HeadlessRunner::refreshEpg(const QStringList &sources, const QString &hourCorrection)
+{
+    ImportWorker worker(m_databaseFile);
+    QEventLoop   loop;
+    QStringList  urls;
+
+    connect(&worker, SIGNAL(epgSourceFinished(QString,int,qint64,QString)), this, SLOT(epgSourceFinished(QString,int,qint64,QString)));
+    connect(&worker, SIGNAL(epgImportFinished(int,int,double,QString,bool)), this, SLOT(epgImportFinished(int,int,double,QString,bool)));
+    connect(&worker, SIGNAL(epgImportFinished(int,int,double,QString,bool)), &loop, SLOT(quit()));
+
+    m_success = m_finished = false;
+
+    // source or source;hours, files are read through file:// urls
+    foreach (const QString &source, sources) {
+
+        QString url = source.section(';', 0, 0);
+        QString hours = source.contains(';') ? source.section(';', 1, 1) : hourCorrection;
+
+        if ( ! isRemote(url) ) {
+            url = QUrl::fromLocalFile(QFileInfo(url).absoluteFilePath()).toString();
+        }
+
+        urls << url + ";" + hours;
+    }
+
+    m_out << "refresh " << urls.size() << " epg sources\n";
+    m_out.flush();
+
+    worker.setEpgChannelFilter(m_epgFilter, m_epgAllowList);
+    worker.refreshEpgSources(urls, this->timestampedFile("epg-%1-") + "%1.xml");
+
+    if ( ! m_finished ) {
+        loop.exec();
+    }
+
+    return m_success;
+}
+
+bool HeadlessRunner::exportPlaylist(const QString &pls_name, const QString &fileName)
+{
+    DbManager db;
+
+    m_out << "export playlist " << pls_name << " to " << fileName << "\n";
+
+    if ( ! db.open(m_databaseFile, "export") ) {
+        m_out << "couldn't open the database " << m_databaseFile << "\n";
+        return false;
+    }
+
+    M3uExporter exporter(db);
+
+    if ( ! exporter.exportPlaylist(pls_name, fileName) ) {
+        m_out << exporter.errorString() << "\n";
+        return false;
+    }
+
+    m_out << exporter.entries() << " stations exported\n";
+
+    return true;
+}
+
+void HeadlessRunner::m3uImportFinished(int stations, int newStations, int changedStations, int vanishedStations,
+                                       int obsolete, int runId, double entriesPerSecond, bool canceled, bool complete)
+{
+    m_out << QString("%1 stations imported: %2 new, %3 changed, %4 vanished, %5 obsolete (%6 entries/s)")
+             .arg(stations)
+             .arg(newStations)
+             .arg(changedStations)
+             .arg(vanishedStations)
+             .arg(obsolete)
+             .arg(entriesPerSecond, 0, 'f', 0) << "\n";
+
+    if ( ! complete && ! canceled ) {
+        m_out << "import incomplete, vanished stations were not checked\n";
+    }
+
+    m_out.flush();
+
+    // a failed download still commits the stations read up to then
+    m_success = complete && runId != 0 && !canceled && !m_failed;
+    m_finished = true;
+}
+
+void HeadlessRunner::m3uDownloadFailed(const QString &error)
+{
+    m_out << "download fails: " << error << "\n";
+    m_out.flush();
+
+    m_failed = true;
+}
+
+void HeadlessRunner::epgImportFinished(int programs, int duplicates, double programsPerSecond, const QString &error, bool canceled)
+{
+    if ( ! error.isEmpty() ) {
+        m_out << "epg import fails: " << error << "\n";
+    }
+
+    m_out << QString("%1 programs imported, %2 duplicates skipped (%3 rows/s)").arg(programs)
+                                                                            .arg(duplicates)
+                                                                            .arg(programsPerSecond, 0, 'f', 0) << "\n";
+    m_out.flush();
+
+    m_success = error.isEmpty() && !canceled;
+    m_finished = true;
+}
+
+void HeadlessRunner::epgSourceFinished(const QString &url, int programs, qint64 msecs, const QString &error)
+{
+    if ( ! error.isEmpty() ) {
+        m_out << url << ": " << error << "\n";
+        m_out.flush();
+        return;
+    }
+
+    m_out << QString("%1: %2 programs in %3 s").arg(url).arg(programs).arg(msecs / 1000.0, 0, 'f', 1) << "\n";
+    m_out.flush();
+}
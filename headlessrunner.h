@@ -0,0 +1,48 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QObject>
+#include <QTextStream>
+#include <QStringList>
+
+#include "dbmanager.h"
+
+// Command line mode for server deployments, runs the imports and exports
+// against the database without creating any widget or vlc instance. Every
+// step blocks in a local event loop until the worker is done.
+
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HeadlessRunner(const QString &databaseFile, QObject *parent = nullptr);
+
+    bool importM3u(const QString &source);
+    bool importEpg(const QString &source, const QString &hourCorrection);
+    bool refreshEpg(const QStringList &sources, const QString &hourCorrection);
+    bool exportPlaylist(const QString &pls_name, const QString &fileName);
+
+    void setEpgChannelFilter(bool enabled, const QStringList &allowList);
+
+    static bool isRemote(const QString &source);
+
+private slots:
+    void m3uImportFinished(int, int, int, int, int, int, double, bool, bool);
+    void m3uDownloadFailed(const QString &error);
+    void epgImportFinished(int, int, double, const QString &, bool);
+    void epgSourceFinished(const QString &, int, qint64, const QString &);
+
+private:
+    QString timestampedFile(const QString &pattern) const;
+
+    QString     m_databaseFile;
+    QString     m_dataPath;
+    QTextStream m_out;
+    bool        m_success;
+    bool        m_failed;
+    bool        m_finished;
+    bool        m_epgFilter;
+    QStringList m_epgAllowList;
+};
+
+#endif // HEADLESSRUNNER_H
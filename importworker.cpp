@@ -0,0 +1,809 @@
+#include "importworker.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QSqlQuery>
+#include <QVariant>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <functional>
+
+#include "epgdownloader.h"
+#include "epgimporter.h"
+#include "epgparser.h"
+#include "m3uimporter.h"
+#include "m3uparser.h"
+#include "streamdownloader.h"
+
+static const qint64 readBlockSize = 256 * 1024;
+static const int    epgSourceCapacity = 50000;
+
+ImportWorker::ImportWorker(const QString &databaseFile, QObject *parent) :
+    QObject(parent),
+    m_databaseFile(databaseFile),
+    m_canceled(0),
+    m_epgFilter(false),
+    m_epgCorrection(0),
+    m_importer(nullptr),
+    m_downloader(nullptr),
+    m_epgDownloader(nullptr),
+    m_epgImporter(nullptr),
+    m_pendingOffset(0),
+    m_streamTotal(0),
+    m_stations(0)
+{
+}
+
+ImportWorker::~ImportWorker()
+{
+    this->stopEpgSources();
+
+    delete m_epgDownloader;
+    delete m_epgImporter;
+    delete m_downloader;
+    delete m_importer;
+}
+
+void ImportWorker::cancel()
+{
+    m_canceled.storeRelease(1);
+}
+
+// takes effect when the worker opens its connection with the first job
+void ImportWorker::setJournal(DbManager::Journal journal)
+{
+    m_db.setJournal(journal);
+}
+
+bool ImportWorker::isCanceled() const
+{
+    return m_canceled.loadAcquire() != 0;
+}
+
+bool ImportWorker::openDatabase()
+{
+    if ( m_db.isOpen() ) {
+        return true;
+    }
+
+    if ( ! m_db.open(m_databaseFile, "import") ) {
+        return false;
+    }
+
+    m_db.createTable();
+
+    return true;
+}
+
+bool ImportWorker::progressDue()
+{
+    // don't flood the event queue of the gui thread
+    if ( m_lastProgress.isValid() && m_lastProgress.elapsed() < 100 ) {
+        return false;
+    }
+
+    m_lastProgress.start();
+
+    return true;
+}
+
+bool ImportWorker::beginM3uImport()
+{
+    m_canceled.storeRelease(0);
+
+    if ( ! this->openDatabase() ) {
+        emit m3uImportFinished(0, 0, 0, 0, 0, 0, 0.0, false, false);
+        return false;
+    }
+
+    delete m_importer;
+    m_importer = new M3uImporter(m_db);
+
+    m_stations = 0;
+
+    if ( ! m_importer->begin() ) {
+        this->finishM3uImport(false);
+        return false;
+    }
+
+    return true;
+}
+
+void ImportWorker::addM3uEntries(M3uParser &m3u, qint64 offset, qint64 total)
+{
+    QString tvg_name;
+    QString tvg_id;
+    int     tvg_chno;
+    QString group_title;
+    QString tvg_logo;
+    QString url;
+
+    M3uEntry      entry;
+    M3uAttributes attributes;
+
+    // progress in kB of the file
+    const int maximum = int(total / 1024);
+
+    while ( !this->isCanceled() && m3u.next(entry) ){
+
+        M3uParser::parseAttributes(entry.tags, attributes);
+
+        url = entry.url.toString();
+        tvg_name = attributes.tvgName.isEmpty() ? entry.station.toString() : attributes.tvgName.toString();
+        tvg_id = attributes.tvgId.toString();
+        group_title = attributes.groupTitle.isEmpty() ? QString("NoGroup") : attributes.groupTitle.toString();
+        tvg_logo = attributes.tvgLogo.isEmpty() ? QString(" ") : attributes.tvgLogo.toString();
+        tvg_chno = attributes.tvgChno.toInt();
+
+        if ( ! m_importer->addEntry(tvg_name, tvg_id, group_title, tvg_logo, url, tvg_chno) ) {
+            qDebug() << "-E-" << "addEntry" << tvg_name << tvg_id << group_title << tvg_logo << url;
+        }
+
+        m_stations++;
+
+        if ( this->progressDue() ) {
+            emit progress(int(( offset + m3u.position() ) / 1024), maximum,
+                          tr("%1 stations (%2 entries/s)").arg(m_stations).arg(m_importer->entriesPerSecond(), 0, 'f', 0));
+        }
+    }
+}
+
+void ImportWorker::finishM3uImport(bool complete)
+{
+    int obsolete = 0;
+
+    complete = complete && !this->isCanceled();
+
+    m_importer->finish(complete);
+
+    // an incomplete import didn't see all stations, nothing is obsolete then
+    if ( complete && m_importer->runId() != 0 ) {
+        obsolete = m_db.countObsoleteEXTINFs(m_importer->runId());
+    }
+
+    emit m3uImportFinished(m_importer->entries(), m_importer->newEntries(), m_importer->changedEntries(), m_importer->vanishedEntries(),
+                           obsolete, m_importer->runId(), m_importer->entriesPerSecond(), this->isCanceled(), complete);
+
+    delete m_importer;
+    m_importer = nullptr;
+}
+
+void ImportWorker::importM3u(const QString &filename)
+{
+    QByteArray buffer;
+    const char *data = nullptr;
+
+    M3uParser m3u;
+
+    if ( ! this->beginM3uImport() ) {
+        return;
+    }
+
+    QFile file(filename);
+
+    if(!file.exists()){
+        qDebug() << "File <i>cannot</i> be found "<<filename;
+    }
+
+    bool complete = false;
+
+    if (file.open(QIODevice::ReadOnly)){
+
+        const QByteArray magic = file.peek(6);
+
+        // a compressed playlist is unpacked and parsed block by block
+        if ( StreamDecompressor::detect(magic.constData(), magic.size()) != StreamDecompressor::Plain ) {
+
+            this->beginM3uData();
+
+            complete = true;
+
+            while ( complete && !file.atEnd() && !this->isCanceled() ) {
+                const QByteArray block = file.read(readBlockSize);
+                complete = !block.isEmpty() && this->addM3uData(block);
+            }
+
+            complete = complete && this->finishM3uData();
+
+            this->finishM3uImport(complete);
+
+            file.close();
+            return;
+        }
+
+        data = reinterpret_cast<const char *>(file.map(0, file.size()));
+
+        if ( data == nullptr ) {
+            buffer = file.readAll();
+            data = buffer.constData();
+        }
+
+        m3u.setData(data, file.size());
+
+        this->addM3uEntries(m3u, 0, m3u.size());
+
+        complete = true;
+    }
+
+    this->finishM3uImport(complete);
+
+    file.close();
+}
+
+void ImportWorker::importM3uUrl(const QString &url, const QString &filename)
+{
+    if ( ! this->beginM3uImport() ) {
+        return;
+    }
+
+    this->beginM3uData();
+
+    delete m_downloader;
+    m_downloader = new StreamDownloader(QUrl(url), filename, this);
+
+    connect(m_downloader, SIGNAL(received(QByteArray)), this, SLOT(m3uStreamReceived(QByteArray)));
+    connect(m_downloader, SIGNAL(progress(qint64,qint64)), this, SLOT(m3uStreamProgress(qint64,qint64)));
+    connect(m_downloader, SIGNAL(finished(bool,QString)), this, SLOT(m3uStreamFinished(bool,QString)));
+
+    m_downloader->start();
+}
+
+void ImportWorker::beginM3uData()
+{
+    m_pending.clear();
+    m_pendingOffset = 0;
+    m_streamTotal = 0;
+
+    // the first bytes tell whether the playlist is compressed
+    m_decompressor.begin(StreamDecompressor::Detect);
+}
+
+bool ImportWorker::addM3uData(const QByteArray &data)
+{
+    M3uParser m3u;
+
+    // only the unfinished tail of the previous chunk is kept
+    if ( ! m_decompressor.decompress(data.constData(), data.size(), m_pending) ) {
+        qDebug() << "addM3uData" << m_decompressor.errorString();
+        return false;
+    }
+
+    m3u.setData(m_pending.constData(), m_pending.size(), false);
+
+    this->addM3uEntries(m3u, m_pendingOffset, m_streamTotal);
+
+    m_pendingOffset += m3u.consumed();
+    m_pending.remove(0, int(m3u.consumed()));
+
+    return true;
+}
+
+bool ImportWorker::finishM3uData()
+{
+    M3uParser m3u;
+
+    const bool complete = m_decompressor.finish(m_pending);
+
+    m3u.setData(m_pending.constData(), m_pending.size(), true);
+    this->addM3uEntries(m3u, m_pendingOffset, m_streamTotal);
+
+    m_pending.clear();
+
+    return complete;
+}
+
+void ImportWorker::m3uStreamReceived(const QByteArray &data)
+{
+    if ( this->isCanceled() || ! this->addM3uData(data) ) {
+        m_downloader->abort();
+    }
+}
+
+void ImportWorker::m3uStreamProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    Q_UNUSED(bytesReceived)
+
+    // the size of a compressed reply says nothing about the parse position
+    if ( m_decompressor.format() != StreamDecompressor::Plain ) {
+        bytesTotal = 0;
+    }
+
+    m_streamTotal = bytesTotal > 0 ? bytesTotal : 0;
+}
+
+void ImportWorker::m3uStreamFinished(bool success, const QString &error)
+{
+    if ( success ) {
+        success = this->finishM3uData();
+    }
+
+    if ( ! success && ! this->isCanceled() ) {
+        const QString reason = m_decompressor.errorString().isEmpty() ? error : m_decompressor.errorString();
+        qDebug() << "importM3uUrl" << reason;
+        emit m3uDownloadFailed(reason);
+    }
+
+    m_pending.clear();
+
+    m_downloader->deleteLater();
+    m_downloader = nullptr;
+
+    this->finishM3uImport(success);
+}
+
+void ImportWorker::setEpgChannelFilter(bool enabled, const QStringList &allowList)
+{
+    m_epgFilter = enabled;
+    m_epgAllowList = allowList;
+
+    // the lists are split from "a,b," without dropping the empty parts
+    m_epgAllowList.removeAll(QString());
+}
+
+bool ImportWorker::beginEpgImport()
+{
+    m_canceled.storeRelease(0);
+
+    if ( ! this->openDatabase() ) {
+        emit epgImportFinished(0, 0, 0.0, tr("Couldn't open the database %1").arg(m_databaseFile), false);
+        return false;
+    }
+
+    m_db.removeOldPrograms();
+
+    return true;
+}
+
+const QSet<QString> *ImportWorker::epgChannelFilter()
+{
+    m_epgChannels.clear();
+
+    if ( ! m_epgFilter ) {
+        return nullptr;
+    }
+
+    // only the channels used by a station, plus the allow list
+    DbCursor select = m_db.selectEXTINF_tvg_ids();
+    while ( select->next() ) {
+        m_epgChannels.insert(select->value(0).toString());
+    }
+    foreach (const QString &channel, m_epgAllowList) {
+        m_epgChannels.insert(channel.trimmed());
+    }
+
+    return &m_epgChannels;
+}
+
+void ImportWorker::importEpg(const QString &sFileName, const QString &sHourCorrection)
+{
+    QString error;
+    int     skipped = 0;
+
+    if ( ! this->beginEpgImport() ) {
+        return;
+    }
+
+    QFile xmlFile(sFileName);
+
+    if (!xmlFile.open(QIODevice::ReadOnly)) {
+        emit epgImportFinished(0, 0, 0.0, tr("Couldn't open %1 to load settings for download").arg(sFileName), false);
+        return;
+    }
+
+    const qint64 correction = qint64(sHourCorrection.toInt()) * 3600;
+
+    const QSet<QString> *filter = this->epgChannelFilter();
+
+    EpgImporter importer(m_db);
+
+    importer.begin();
+
+    const QByteArray magic = xmlFile.peek(6);
+    const StreamDecompressor::Format format = StreamDecompressor::detect(magic.constData(), magic.size());
+
+    if ( format != StreamDecompressor::Plain ) {
+        skipped = this->importEpgCompressed(xmlFile, format, filter, correction, importer, error);
+    } else {
+        skipped = this->importEpgMapped(xmlFile, filter, correction, importer, error);
+    }
+
+    importer.finish();
+
+    if ( m_epgFilter ) {
+        qDebug() << "importEpg" << skipped << "programs of unused channels skipped," << m_epgChannels.size() << "channels kept";
+    }
+
+    xmlFile.close();
+
+    emit epgImportFinished(importer.programs(), importer.duplicates(), importer.programsPerSecond(), error, this->isCanceled());
+}
+
+void ImportWorker::importEpgUrl(const QString &url, const QString &filename, const QString &sHourCorrection)
+{
+    if ( ! this->beginEpgImport() ) {
+        return;
+    }
+
+    m_epgCorrection = qint64(sHourCorrection.toInt()) * 3600;
+
+    delete m_epgImporter;
+    m_epgImporter = new EpgImporter(m_db);
+
+    m_epgImporter->begin();
+
+    delete m_epgDownloader;
+    m_epgDownloader = new EpgDownloader(QUrl(url), filename, this);
+
+    m_epgDownloader->setChannelFilter(this->epgChannelFilter());
+
+    connect(m_epgDownloader, SIGNAL(received()), this, SLOT(epgStreamReceived()));
+    connect(m_epgDownloader, SIGNAL(finished(bool,QString)), this, SLOT(epgStreamFinished(bool,QString)));
+
+    m_epgDownloader->start();
+}
+
+void ImportWorker::epgStreamReceived()
+{
+    if ( this->isCanceled() ) {
+        m_epgDownloader->abort();
+        return;
+    }
+
+    // written while the next chunk is still on its way
+    this->addEpgPrograms(*m_epgImporter, m_epgDownloader->takePrograms(), m_epgCorrection,
+                         int(m_epgDownloader->bytesReceived() / 1024), int(m_epgDownloader->bytesTotal() / 1024));
+}
+
+void ImportWorker::epgStreamFinished(bool success, const QString &error)
+{
+    m_epgImporter->finish();
+
+    if ( m_epgFilter ) {
+        qDebug() << "importEpgUrl" << m_epgDownloader->skipped() << "programs of unused channels skipped," << m_epgChannels.size() << "channels kept";
+    }
+
+    emit epgImportFinished(m_epgImporter->programs(), m_epgImporter->duplicates(), m_epgImporter->programsPerSecond(),
+                           success || this->isCanceled() ? QString() : error, this->isCanceled());
+
+    m_epgDownloader->deleteLater();
+    m_epgDownloader = nullptr;
+
+    delete m_epgImporter;
+    m_epgImporter = nullptr;
+}
+
+void ImportWorker::refreshEpgSources(const QStringList &sources, const QString &filePattern)
+{
+    if ( ! this->beginEpgImport() ) {
+        return;
+    }
+
+    this->stopEpgSources();
+
+    m_epgErrors.clear();
+
+    delete m_epgImporter;
+    m_epgImporter = new EpgImporter(m_db);
+
+    m_epgImporter->begin();
+
+    const QSet<QString> *filter = this->epgChannelFilter();
+
+    // every source is downloaded and parsed on a thread of its own, the
+    // programmes all come back to this thread as the single writer
+    foreach (const QString &value, sources) {
+
+        EpgSource source;
+
+        source.url = value.section(';', 0, 0).trimmed();
+        source.correction = qint64(value.section(';', 1, 1).toInt()) * 3600;
+        source.programs = 0;
+        source.done = false;
+
+        if ( source.url.isEmpty() ) {
+            continue;
+        }
+
+        const QUrl url(source.url);
+
+        // a local file is only read, not copied
+        QString filename = url.isLocalFile() || filePattern.isEmpty() ? QString() : filePattern.arg(m_epgSources.size() + 1);
+
+        // the raw reply is written, a packed source keeps its suffix
+        if ( ! filename.isEmpty() ) {
+            if ( url.path().endsWith(".gz") ) {
+                filename += ".gz";
+            } else if ( url.path().endsWith(".xz") ) {
+                filename += ".xz";
+            }
+        }
+
+        source.downloader = new EpgDownloader(url, filename);
+        source.downloader->setChannelFilter(filter);
+        source.downloader->setCapacity(epgSourceCapacity);
+
+        source.thread = new QThread();
+        source.downloader->moveToThread(source.thread);
+
+        connect(source.thread, SIGNAL(started()), source.downloader, SLOT(start()));
+        connect(source.thread, SIGNAL(finished()), source.downloader, SLOT(deleteLater()));
+        connect(source.thread, SIGNAL(finished()), source.thread, SLOT(deleteLater()));
+        connect(source.downloader, SIGNAL(received()), this, SLOT(epgSourceReceived()));
+        connect(source.downloader, SIGNAL(finished(bool,QString)), this, SLOT(epgSourceDone(bool,QString)));
+
+        source.timer.start();
+
+        m_epgSources.append(source);
+    }
+
+    if ( m_epgSources.isEmpty() ) {
+        this->epgSourceDone(false, QString());
+        return;
+    }
+
+    for ( int i = 0; i < m_epgSources.size(); i++ ) {
+        m_epgSources[i].thread->start();
+    }
+}
+
+int ImportWorker::epgSource(QObject *downloader) const
+{
+    for ( int i = 0; i < m_epgSources.size(); i++ ) {
+        if ( m_epgSources.at(i).downloader == downloader ) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void ImportWorker::epgSourceReceived()
+{
+    const int index = this->epgSource(this->sender());
+
+    if ( index < 0 ) {
+        return;
+    }
+
+    if ( this->isCanceled() ) {
+
+        for ( int i = 0; i < m_epgSources.size(); i++ ) {
+            if ( ! m_epgSources.at(i).done ) {
+                m_epgSources.at(i).downloader->release();
+                QMetaObject::invokeMethod(m_epgSources.at(i).downloader, "abort", Qt::QueuedConnection);
+            }
+        }
+        return;
+    }
+
+    EpgSource &source = m_epgSources[index];
+
+    qint64 received = 0;
+    qint64 total = 0;
+
+    for ( int i = 0; i < m_epgSources.size(); i++ ) {
+        if ( ! m_epgSources.at(i).done ) {
+            received += m_epgSources.at(i).downloader->bytesReceived();
+            total += m_epgSources.at(i).downloader->bytesTotal();
+        }
+    }
+
+    const int before = m_epgImporter->programs() + m_epgImporter->duplicates();
+
+    this->addEpgPrograms(*m_epgImporter, source.downloader->takePrograms(), source.correction,
+                         int(received / 1024), int(total / 1024));
+
+    source.programs += m_epgImporter->programs() + m_epgImporter->duplicates() - before;
+}
+
+void ImportWorker::epgSourceDone(bool success, const QString &error)
+{
+    const int index = this->epgSource(this->sender());
+
+    if ( index >= 0 ) {
+
+        // what came in together with the end of the reply
+        this->epgSourceReceived();
+
+        EpgSource &source = m_epgSources[index];
+
+        qDebug() << "refreshEpgSources" << source.url << source.programs << "programs in" << source.timer.elapsed() << "ms,"
+                 << source.downloader->skipped() << "skipped";
+
+        if ( ! success && ! this->isCanceled() ) {
+            m_epgErrors << QString("%1: %2").arg(source.url).arg(error);
+        }
+
+        emit epgSourceFinished(source.url, source.programs, source.timer.elapsed(), success ? QString() : error);
+
+        source.done = true;
+        source.downloader = nullptr;
+        source.thread->quit();
+        source.thread = nullptr;
+    }
+
+    for ( int i = 0; i < m_epgSources.size(); i++ ) {
+        if ( ! m_epgSources.at(i).done ) {
+            return;
+        }
+    }
+
+    m_epgImporter->finish();
+
+    emit epgImportFinished(m_epgImporter->programs(), m_epgImporter->duplicates(), m_epgImporter->programsPerSecond(),
+                           m_epgErrors.join("\n"), this->isCanceled());
+
+    m_epgSources.clear();
+
+    delete m_epgImporter;
+    m_epgImporter = nullptr;
+}
+
+void ImportWorker::stopEpgSources()
+{
+    for ( int i = 0; i < m_epgSources.size(); i++ ) {
+
+        EpgSource &source = m_epgSources[i];
+
+        if ( source.done ) {
+            continue;
+        }
+
+        source.downloader->disconnect(this);
+        source.downloader->release();
+
+        source.thread->quit();
+        source.thread->wait();
+
+        delete source.thread;
+    }
+
+    m_epgSources.clear();
+}
+
+int ImportWorker::importEpgMapped(QFile &xmlFile, const QSet<QString> *channels, qint64 correction,
+                                  EpgImporter &importer, QString &error)
+{
+    QByteArray  buffer;
+    const char *data = nullptr;
+    int         skipped = 0;
+
+    data = reinterpret_cast<const char *>(xmlFile.map(0, xmlFile.size()));
+
+    if ( data == nullptr ) {
+        buffer = xmlFile.readAll();
+        data = buffer.constData();
+    }
+
+    // the chunks are parsed on the thread pool, this thread is the only writer
+    EpgParser parser(data, xmlFile.size());
+
+    parser.setChannelFilter(channels);
+
+    const int threads = qMax(1, QThread::idealThreadCount());
+    const QVector<EpgChunk> chunks = parser.split(threads * 16);
+
+    std::function<EpgChunkResult(const EpgChunk &)> parse = [&parser](const EpgChunk &chunk) {
+        return parser.parseChunk(chunk);
+    };
+
+    // a window of chunks at a time keeps the decoded programmes bounded, the
+    // next window is parsed while the current one is written
+    const int window = threads * 2;
+
+    QFuture<EpgChunkResult> future = QtConcurrent::mapped(chunks.mid(0, window), parse);
+
+    for ( int first = 0; first < chunks.size(); first += window ) {
+
+        QFuture<EpgChunkResult> next;
+
+        if ( first + window < chunks.size() && !this->isCanceled() && error.isEmpty() ) {
+            next = QtConcurrent::mapped(chunks.mid(first + window, window), parse);
+        }
+
+        for ( int i = first; i < qMin(first + window, chunks.size()) && !this->isCanceled(); i++ ) {
+
+            const EpgChunkResult result = future.resultAt(i - first);
+
+            if ( ! result.error.isEmpty() && error.isEmpty() ) {
+                error = result.error;
+            }
+
+            skipped += result.skipped;
+
+            this->addEpgPrograms(importer, result.programs, correction, i, chunks.size());
+        }
+
+        future.waitForFinished();
+
+        if ( ! error.isEmpty() || this->isCanceled() ) {
+            next.waitForFinished();
+            break;
+        }
+
+        future = next;
+    }
+
+    return skipped;
+}
+
+int ImportWorker::importEpgCompressed(QFile &xmlFile, StreamDecompressor::Format format, const QSet<QString> *channels,
+                                      qint64 correction, EpgImporter &importer, QString &error)
+{
+    StreamDecompressor decompressor;
+    EpgStreamParser    parser(channels);
+    EpgChunkResult     result;
+    QByteArray         xml;
+
+    // one block at a time, the uncompressed document is never there as a whole
+    if ( ! decompressor.begin(format) ) {
+        error = decompressor.errorString();
+        return 0;
+    }
+
+    const int maximum = int(xmlFile.size() / 1024);
+
+    while ( !xmlFile.atEnd() && !this->isCanceled() && result.error.isEmpty() ) {
+
+        const QByteArray block = xmlFile.read(readBlockSize);
+
+        xml.clear();
+
+        if ( block.isEmpty() || ! decompressor.decompress(block.constData(), block.size(), xml) ) {
+            break;
+        }
+
+        parser.addData(xml);
+        parser.parse(result);
+
+        this->addEpgPrograms(importer, result.programs, correction, int(xmlFile.pos() / 1024), maximum);
+        result.programs.clear();
+    }
+
+    if ( ! this->isCanceled() && result.error.isEmpty() ) {
+
+        xml.clear();
+
+        if ( decompressor.finish(xml) ) {
+            parser.addData(xml);
+            parser.finish(result);
+
+            this->addEpgPrograms(importer, result.programs, correction, maximum, maximum);
+        }
+    }
+
+    if ( ! decompressor.errorString().isEmpty() ) {
+        error = tr("%1: %2").arg(xmlFile.fileName()).arg(decompressor.errorString());
+    } else if ( ! result.error.isEmpty() ) {
+        error = result.error;
+    }
+
+    return result.skipped;
+}
+
+void ImportWorker::addEpgPrograms(EpgImporter &importer, const QVector<EpgProgram> &programs, qint64 correction,
+                                  int value, int maximum)
+{
+    foreach (EpgProgram program, programs) {
+
+        if ( this->isCanceled() ) {
+            break;
+        }
+
+        // no timestamp, nothing the lookups could ever find
+        if ( program.start == 0 || program.stop == 0 ) {
+            continue;
+        }
+
+        program.start += correction;
+        program.stop += correction;
+
+        importer.addProgram(program.start, program.stop, program.channel, program.title, program.desc);
+
+        if ( this->progressDue() ) {
+            emit progress(value, maximum, tr("%1 programs (%2 rows/s)").arg(importer.programs() + importer.duplicates())
+                                                                     .arg(importer.programsPerSecond(), 0, 'f', 0));
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef IMPORTWORKER_H
+#define IMPORTWORKER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+#include "dbmanager.h"
+#include "epgparser.h"
+#include "streamdecompressor.h"
+
+class EpgImporter;
+
+class QFile;
+class QThread;
+class EpgDownloader;
+class M3uImporter;
+class M3uParser;
+class StreamDownloader;
+
+// Runs the m3u and EPG imports on a worker thread. The worker opens its own
+// database connection on the first job and reports back through queued
+// signals, cancel() may be called from any thread. importM3uUrl() downloads
+// a playlist on the worker thread and imports the stations while the rest of
+// the reply is still on its way. Playlists and EPG files may be gzip or xz
+// compressed, they are unpacked block by block while parsing. importEpgUrl()
+// does the same for an XMLTV download, parsing and writing overlap with the
+// transfer. refreshEpgSources() downloads and parses several XMLTV sources
+// at once, each on a thread of its own, this thread writes them all.
+
+class ImportWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ImportWorker(const QString &databaseFile, QObject *parent = nullptr);
+    ~ImportWorker() override;
+
+    void cancel();
+    void setJournal(DbManager::Journal journal);
+
+public slots:
+    void importM3u(const QString &filename);
+    void importM3uUrl(const QString &url, const QString &filename);
+    void importEpg(const QString &filename, const QString &hourCorrection);
+    void importEpgUrl(const QString &url, const QString &filename, const QString &hourCorrection);
+    void refreshEpgSources(const QStringList &sources, const QString &filePattern);
+    void setEpgChannelFilter(bool enabled, const QStringList &allowList);
+
+signals:
+    void progress(int value, int maximum, const QString &message);
+    void m3uImportFinished(int stations, int newStations, int changedStations, int vanishedStations,
+                           int obsoleteStations, int runId, double entriesPerSecond, bool canceled, bool complete);
+    void m3uDownloadFailed(const QString &error);
+    void epgImportFinished(int programs, int duplicates, double programsPerSecond, const QString &error, bool canceled);
+    void epgSourceFinished(const QString &url, int programs, qint64 msecs, const QString &error);
+
+private slots:
+    void m3uStreamReceived(const QByteArray &data);
+    void m3uStreamProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void m3uStreamFinished(bool success, const QString &error);
+    void epgStreamReceived();
+    void epgStreamFinished(bool success, const QString &error);
+    void epgSourceReceived();
+    void epgSourceDone(bool success, const QString &error);
+
+private:
+    bool beginM3uImport();
+    void addM3uEntries(M3uParser &m3u, qint64 offset, qint64 total);
+    void finishM3uImport(bool complete);
+
+    bool beginEpgImport();
+    const QSet<QString> *epgChannelFilter();
+
+    void beginM3uData();
+    bool addM3uData(const QByteArray &data);
+    bool finishM3uData();
+
+    int  importEpgMapped(QFile &xmlFile, const QSet<QString> *channels, qint64 correction,
+                         EpgImporter &importer, QString &error);
+    int  importEpgCompressed(QFile &xmlFile, StreamDecompressor::Format format, const QSet<QString> *channels,
+                             qint64 correction, EpgImporter &importer, QString &error);
+    void addEpgPrograms(EpgImporter &importer, const QVector<EpgProgram> &programs, qint64 correction,
+                        int value, int maximum);
+    int  epgSource(QObject *downloader) const;
+    void stopEpgSources();
+
+    bool openDatabase();
+    bool isCanceled() const;
+    bool progressDue();
+
+    QString       m_databaseFile;
+    DbManager     m_db;
+    QAtomicInt    m_canceled;
+    QElapsedTimer m_lastProgress;
+
+    bool          m_epgFilter;
+    QStringList   m_epgAllowList;
+    QSet<QString> m_epgChannels;
+    qint64        m_epgCorrection;
+
+    M3uImporter      *m_importer;
+    StreamDownloader *m_downloader;
+    EpgDownloader    *m_epgDownloader;
+    EpgImporter      *m_epgImporter;
+
+    struct EpgSource
+    {
+        QString        url;
+        qint64         correction;
+        EpgDownloader *downloader;
+        QThread       *thread;
+        QElapsedTimer  timer;
+        int            programs;
+        bool           done;
+    };
+
+    QVector<EpgSource> m_epgSources;
+    QStringList        m_epgErrors;
+    QByteArray        m_pending;
+    qint64            m_pendingOffset;
+    qint64            m_streamTotal;
+    StreamDecompressor m_decompressor;
+    int               m_stations;
+};
+
+#endif // IMPORTWORKER_H
@@ -0,0 +1,110 @@
+#include "m3uexporter.h"
+
+#include <QDebug>
+#include <QSqlQuery>
+#include <QVariant>
+
+M3uExporter::M3uExporter(DbManager &db) :
+    m_db(db),
+    m_entries(0)
+{
+}
+
+bool M3uExporter::exportPlaylist(const QString& pls_name, const QString& fileName)
+{
+    DbCursor select;
+    int      pls_id = 0;
+
+    select = m_db.selectPLS_by_pls_name(pls_name);
+    if ( select->next() ) {
+        pls_id = select->value(0).toInt();
+    }
+    if ( pls_id == 0 ) {
+        m_error = QString("playlist %1 not found").arg(pls_name);
+        return false;
+    }
+
+    if ( ! this->open(fileName) ) {
+        return false;
+    }
+
+    select = m_db.selectPLS_Items_m3u(pls_id);
+    while ( select->next() ) {
+        this->writeEntry(select->value(0).toString(), select->value(1).toString(), pls_name,
+                         select->value(2).toString(), select->value(3).toString());
+    }
+    return this->close();
+}
+
+bool M3uExporter::exportStations(const QList<int>& extinf_ids, const QString& group_title, const QString& fileName)
+{
+    if ( ! this->open(fileName) ) {
+        return false;
+    }
+
+    ExtinfRow station;
+
+    foreach (int extinf_id, extinf_ids) {
+
+        if ( m_db.selectEXTINF_byRef(extinf_id, station) ) {
+            this->writeEntry(station.tvg_name, station.tvg_id, group_title, station.tvg_logo, station.url);
+        }
+    }
+
+    return this->close();
+}
+
+int M3uExporter::entries() const
+{
+    return m_entries;
+}
+
+QString M3uExporter::errorString() const
+{
+    return m_error;
+}
+
+bool M3uExporter::open(const QString& fileName)
+{
+    m_entries = 0;
+    m_error.clear();
+
+    m_file.setFileName(fileName);
+
+    if ( ! m_file.open(QFile::WriteOnly | QFile::Text) ) {
+        m_error = QString("Could not open file '%1' for writing").arg(fileName);
+        qDebug() << m_error;
+        return false;
+    }
+
+    m_out.setDevice(&m_file);
+    m_out.setCodec("UTF-8");
+
+    m_out << "#EXTM3U\n";
+
+    return true;
+}
+
+void M3uExporter::writeEntry(const QString& title, const QString& tvg_id, const QString& group,
+                             const QString& logo, const QString& url)
+{
+    m_entries++;
+
+    m_out << QString("#EXTINF:-1 tvg-chno=\"%6\" tvg-name=\"%1\" tvg-id=\"%2\" group-title=\"%3\" tvg-logo=\"%4\",%1\n%5\n")
+             .arg(title).arg(tvg_id).arg(group).arg(logo).arg(url).arg(m_entries);
+}
+
+bool M3uExporter::close()
+{
+    m_out.flush();
+    m_out.setDevice(nullptr);
+
+    m_file.close();
+
+    if ( m_file.error() != QFile::NoError ) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    return true;
+}
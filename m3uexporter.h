@@ -0,0 +1,36 @@
+#ifndef M3UEXPORTER_H
+#define M3UEXPORTER_H
+
+#include <QFile>
+#include <QList>
+#include <QTextStream>
+
+#include "dbmanager.h"
+
+// Writes the stations of a playlist as m3u file, used by the gui and the
+// command line mode alike.
+
+class M3uExporter
+{
+public:
+    explicit M3uExporter(DbManager &db);
+
+    bool exportPlaylist(const QString& pls_name, const QString& fileName);
+    bool exportStations(const QList<int>& extinf_ids, const QString& group_title, const QString& fileName);
+
+    int entries() const;
+    QString errorString() const;
+
+private:
+    bool open(const QString&);
+    void writeEntry(const QString&, const QString&, const QString&, const QString&, const QString&);
+    bool close();
+
+    DbManager   &m_db;
+    QFile       m_file;
+    QTextStream m_out;
+    int         m_entries;
+    QString     m_error;
+};
+
+#endif // M3UEXPORTER_H
@@ -0,0 +1,461 @@
+#include "m3uimporter.h"
+
+#include <QDebug>
+#include <QVariant>
+#include <QSqlError>
+
+M3uImporter::M3uImporter(DbManager &db, int chunkSize) :
+    m_db(db),
+    m_chunkSize(chunkSize),
+    m_active(false),
+    m_runId(0),
+    m_entries(0),
+    m_newEntries(0),
+    m_changedEntries(0),
+    m_vanishedEntries(0),
+    m_chunkEntries(0)
+{
+}
+
+M3uImporter::~M3uImporter()
+{
+    // an import torn down half way must not mark the unread stations as vanished
+    if ( m_active ) {
+        this->finish(false);
+    }
+}
+
+bool M3uImporter::begin()
+{
+    DbCursor select;
+
+    m_groups.clear();
+    m_groupTitles.clear();
+    m_playlists.clear();
+    m_urls.clear();
+    m_plsItems.clear();
+    m_seen.clear();
+
+    m_entries = m_newEntries = m_changedEntries = m_vanishedEntries = m_chunkEntries = 0;
+    m_timer.start();
+
+    m_runId = m_db.insertImportRun();
+
+    if ( m_runId == 0 ) {
+        return false;
+    }
+
+    // ------------------------------------------------
+    // load the lookup tables once
+    // ------------------------------------------------
+    select = m_db.selectGroups(0);
+    while ( select->next() ) {
+        const QString title = select->value(1).toString();
+        if ( ! m_groups.contains(title) ) {
+            m_groups.insert(title, select->value(0).toInt());
+        }
+        m_groupTitles.insert(select->value(0).toInt(), title);
+    }
+    select = m_db.selectPLS(0);
+    while ( select->next() ) {
+        const QString name = select->value(1).toString();
+        if ( ! m_playlists.contains(name) ) {
+            m_playlists.insert(name, select->value(0).toInt());
+        }
+    }
+    select = m_db.selectEXTINF_urls();
+    while ( select->next() ) {
+        Station station;
+        station.id = select->value(0).toInt();
+        station.fingerprint = select->value(2).toLongLong();
+        station.state = select->value(3).toInt();
+        station.group_id = select->value(4).toInt();
+        m_urls.insert(select->value(1).toString(), station);
+    }
+    select = m_db.selectPLS_Items_keys();
+    while ( select->next() ) {
+        m_plsItems.insert(itemKey(select->value(0).toInt(), select->value(1).toInt()));
+    }
+    // ------------------------------------------------
+    // prepare the statements used for every row
+    // ------------------------------------------------
+    m_insertGroup = QSqlQuery(m_db.database());
+    m_insertEXTINF = QSqlQuery(m_db.database());
+    m_updateEXTINF = QSqlQuery(m_db.database());
+    m_stampEXTINF = QSqlQuery(m_db.database());
+    m_insertPLS = QSqlQuery(m_db.database());
+    m_insertPLS_Item = QSqlQuery(m_db.database());
+    m_updatePLS_Item = QSqlQuery(m_db.database());
+    m_removePLS_Item = QSqlQuery(m_db.database());
+
+    m_insertGroup.prepare("INSERT INTO groups (group_title, favorite ) VALUES (:group_title, 0)");
+    m_insertEXTINF.prepare("INSERT INTO extinf (tvg_name, tvg_id, group_id, tvg_logo, url, state, last_seen, fingerprint ) VALUES (:tvg_name, :tvg_id, :group_id, :tvg_logo, :url, 2, :last_seen, :fingerprint)");
+    m_updateEXTINF.prepare("UPDATE extinf SET tvg_name = :tvg_name, tvg_id = :tvg_id, group_id = :group_id, tvg_logo = :tvg_logo, state = 1, last_seen = :last_seen, fingerprint = :fingerprint WHERE id = :id");
+    m_stampEXTINF.prepare("UPDATE extinf SET state = :state, last_seen = :last_seen WHERE id = :id");
+    m_insertPLS.prepare("INSERT INTO pls (pls_name, favorite) VALUES (:pls_name, 0)");
+    m_insertPLS_Item.prepare("INSERT INTO pls_item (pls_id, extinf_id, pls_pos) VALUES (:pls_id, :extinf_id, :pls_pos )");
+    m_updatePLS_Item.prepare("UPDATE pls_item SET pls_pos = :pls_pos WHERE pls_id = :pls_id AND extinf_id = :extinf_id");
+    m_removePLS_Item.prepare("DELETE FROM pls_item WHERE pls_id = :pls_id AND extinf_id = :extinf_id");
+
+    m_active = m_db.transaction();
+
+    return m_active;
+}
+
+bool M3uImporter::addEntry(const QString& tvg_name, const QString& tvg_id, const QString& group_title,
+                           const QString& tvg_logo, const QString& url, int tvg_chno)
+{
+    bool success = true;
+    int  changed_from = 0;
+
+    const int group_id = this->groupId(group_title);
+    const int extinf_id = this->extinfId(tvg_name, tvg_id, group_id, tvg_logo, url,
+                                         fingerprint(tvg_name, tvg_id, group_title, tvg_logo, url, tvg_chno), changed_from);
+    const int pls_id = this->playlistId(group_title);
+
+    if ( extinf_id == 0 || pls_id == 0 ) {
+        success = false;
+    } else if ( changed_from != 0 && ! this->movePlaylistItem(changed_from, pls_id, extinf_id, tvg_chno) ) {
+        success = false;
+    } else if ( ! this->addPlaylistItem(pls_id, extinf_id, tvg_chno) ) {
+        success = false;
+    }
+
+    m_entries++;
+
+    if ( ++m_chunkEntries >= m_chunkSize ) {
+        success = this->nextChunk() && success;
+    }
+
+    return success;
+}
+
+bool M3uImporter::finish(bool complete)
+{
+    bool success = true;
+
+    // only a complete import knows which stations are gone
+    if ( m_active && complete ) {
+        success = this->removeVanished();
+    }
+
+    if ( m_active ) {
+        success = m_db.commit() && success;
+        m_active = false;
+    }
+
+    if ( m_runId != 0 ) {
+        success = m_db.finishImportRun(m_runId, m_entries) && success;
+    }
+
+    m_db.checkpoint();
+
+    m_insertGroup.finish();
+    m_insertEXTINF.finish();
+    m_updateEXTINF.finish();
+    m_stampEXTINF.finish();
+    m_insertPLS.finish();
+    m_insertPLS_Item.finish();
+    m_updatePLS_Item.finish();
+    m_removePLS_Item.finish();
+
+    qDebug() << "M3uImporter" << m_entries << "entries," << m_newEntries << "new," << m_changedEntries << "changed,"
+             << m_vanishedEntries << "vanished in" << this->elapsed() << "ms";
+
+    return success;
+}
+
+int M3uImporter::runId() const
+{
+    return m_runId;
+}
+
+int M3uImporter::entries() const
+{
+    return m_entries;
+}
+
+int M3uImporter::newEntries() const
+{
+    return m_newEntries;
+}
+
+qint64 M3uImporter::elapsed() const
+{
+    return m_timer.isValid() ? m_timer.elapsed() : 0;
+}
+
+int M3uImporter::changedEntries() const
+{
+    return m_changedEntries;
+}
+
+int M3uImporter::vanishedEntries() const
+{
+    return m_vanishedEntries;
+}
+
+double M3uImporter::entriesPerSecond() const
+{
+    const qint64 msecs = this->elapsed();
+
+    return msecs > 0 ? m_entries * 1000.0 / msecs : 0.0;
+}
+
+int M3uImporter::groupId(const QString& group_title)
+{
+    QHash<QString, int>::const_iterator it = m_groups.constFind(group_title);
+
+    if ( it != m_groups.constEnd() ) {
+        return it.value();
+    }
+
+    int id = 0;
+
+    m_insertGroup.bindValue(":group_title", group_title);
+
+    if ( m_insertGroup.exec() ) {
+        id = m_insertGroup.lastInsertId().toInt();
+        m_groups.insert(group_title, id);
+        m_groupTitles.insert(id, group_title);
+    } else {
+        qDebug() << "addGroup" << m_insertGroup.lastError() << group_title;
+    }
+
+    return id;
+}
+
+int M3uImporter::playlistId(const QString& pls_name)
+{
+    QHash<QString, int>::const_iterator it = m_playlists.constFind(pls_name);
+
+    if ( it != m_playlists.constEnd() ) {
+        return it.value();
+    }
+
+    int id = 0;
+
+    m_insertPLS.bindValue(":pls_name", pls_name);
+
+    if ( m_insertPLS.exec() ) {
+        id = m_insertPLS.lastInsertId().toInt();
+        m_playlists.insert(pls_name, id);
+    } else {
+        qDebug() << "insertPLS" << m_insertPLS.lastError() << pls_name;
+    }
+
+    return id;
+}
+
+// changed_from is the group of a changed station before the update, 0 otherwise
+int M3uImporter::extinfId(const QString& tvg_name, const QString& tvg_id, int group_id, const QString& tvg_logo, const QString& url,
+                          qint64 fingerprint, int& changed_from)
+{
+    changed_from = 0;
+
+    QHash<QString, Station>::iterator it = m_urls.find(url);
+
+    if ( it != m_urls.end() ) {
+
+        Station &station = it.value();
+
+        // unchanged and already active, nothing to write
+        if ( m_seen.contains(station.id) || ( station.fingerprint == fingerprint && station.state == 1 ) ) {
+            m_seen.insert(station.id);
+            return station.id;
+        }
+
+        if ( station.fingerprint != fingerprint ) {
+
+            m_updateEXTINF.bindValue(":tvg_name", tvg_name);
+            m_updateEXTINF.bindValue(":tvg_id", tvg_id);
+            m_updateEXTINF.bindValue(":group_id", group_id);
+            m_updateEXTINF.bindValue(":tvg_logo", tvg_logo);
+            m_updateEXTINF.bindValue(":last_seen", m_runId);
+            m_updateEXTINF.bindValue(":fingerprint", fingerprint);
+            m_updateEXTINF.bindValue(":id", station.id);
+
+            if ( m_updateEXTINF.exec() ) {
+                m_changedEntries++;
+                changed_from = station.group_id;
+            } else {
+                qDebug() << "updateEXTINF" << m_updateEXTINF.lastError() << url;
+            }
+
+        } else {
+
+            // new or obsolete before, active again
+            m_stampEXTINF.bindValue(":state", 1);
+            m_stampEXTINF.bindValue(":last_seen", m_runId);
+            m_stampEXTINF.bindValue(":id", station.id);
+
+            if ( ! m_stampEXTINF.exec() ) {
+                qDebug() << "stampEXTINF" << m_stampEXTINF.lastError() << url;
+            }
+        }
+
+        station.fingerprint = fingerprint;
+        station.state = 1;
+        station.group_id = group_id;
+        m_seen.insert(station.id);
+
+        return station.id;
+    }
+
+    int id = 0;
+
+    m_insertEXTINF.bindValue(":tvg_name", tvg_name);
+    m_insertEXTINF.bindValue(":tvg_id", tvg_id);
+    m_insertEXTINF.bindValue(":group_id", group_id);
+    m_insertEXTINF.bindValue(":tvg_logo", tvg_logo);
+    m_insertEXTINF.bindValue(":url", url);
+    m_insertEXTINF.bindValue(":last_seen", m_runId);
+    m_insertEXTINF.bindValue(":fingerprint", fingerprint);
+
+    if ( m_insertEXTINF.exec() ) {
+        id = m_insertEXTINF.lastInsertId().toInt();
+
+        Station station;
+        station.id = id;
+        station.fingerprint = fingerprint;
+        station.state = 2;
+        station.group_id = group_id;
+
+        m_urls.insert(url, station);
+        m_seen.insert(id);
+        m_newEntries++;
+    } else {
+        qDebug() << "addEXTINF" << m_insertEXTINF.lastError() << url;
+    }
+
+    return id;
+}
+
+bool M3uImporter::removeVanished()
+{
+    bool success = true;
+
+    QHash<QString, Station>::iterator it;
+
+    for ( it = m_urls.begin(); it != m_urls.end(); ++it ) {
+
+        Station &station = it.value();
+
+        if ( station.state == 0 || m_seen.contains(station.id) ) {
+            continue;
+        }
+
+        m_stampEXTINF.bindValue(":state", 0);
+        m_stampEXTINF.bindValue(":last_seen", m_runId);
+        m_stampEXTINF.bindValue(":id", station.id);
+
+        if ( ! m_stampEXTINF.exec() ) {
+            qDebug() << "stampEXTINF" << m_stampEXTINF.lastError() << it.key();
+            success = false;
+            continue;
+        }
+
+        station.state = 0;
+        m_vanishedEntries++;
+    }
+
+    return success;
+}
+
+bool M3uImporter::addPlaylistItem(int pls_id, int extinf_id, int pls_pos)
+{
+    const qint64 key = itemKey(pls_id, extinf_id);
+
+    if ( m_plsItems.contains(key) ) {
+        return true;
+    }
+
+    m_insertPLS_Item.bindValue(":pls_id", pls_id);
+    m_insertPLS_Item.bindValue(":extinf_id", extinf_id);
+    m_insertPLS_Item.bindValue(":pls_pos", pls_pos);
+
+    if ( ! m_insertPLS_Item.exec() ) {
+        qDebug() << "insertPLS_Item" << m_insertPLS_Item.lastError() << pls_id << extinf_id << pls_pos;
+        return false;
+    }
+
+    m_plsItems.insert(key);
+
+    return true;
+}
+
+// a changed station leaves the playlist of its old group, in the playlist
+// of its group it takes the new channel number as position
+bool M3uImporter::movePlaylistItem(int old_group_id, int pls_id, int extinf_id, int pls_pos)
+{
+    const int    old_pls_id = m_playlists.value(m_groupTitles.value(old_group_id), 0);
+    const qint64 old_key = itemKey(old_pls_id, extinf_id);
+    const qint64 key = itemKey(pls_id, extinf_id);
+
+    if ( old_pls_id != 0 && old_pls_id != pls_id && m_plsItems.contains(old_key) ) {
+
+        m_removePLS_Item.bindValue(":pls_id", old_pls_id);
+        m_removePLS_Item.bindValue(":extinf_id", extinf_id);
+
+        if ( ! m_removePLS_Item.exec() ) {
+            qDebug() << "removePLS_Item" << m_removePLS_Item.lastError() << old_pls_id << extinf_id;
+            return false;
+        }
+
+        m_plsItems.remove(old_key);
+    }
+
+    if ( m_plsItems.contains(key) ) {
+
+        m_updatePLS_Item.bindValue(":pls_pos", pls_pos);
+        m_updatePLS_Item.bindValue(":pls_id", pls_id);
+        m_updatePLS_Item.bindValue(":extinf_id", extinf_id);
+
+        if ( ! m_updatePLS_Item.exec() ) {
+            qDebug() << "updatePLS_Item" << m_updatePLS_Item.lastError() << pls_id << extinf_id << pls_pos;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool M3uImporter::nextChunk()
+{
+    m_chunkEntries = 0;
+
+    if ( ! m_db.commit() ) {
+        m_active = false;
+        return false;
+    }
+
+    m_active = m_db.transaction();
+
+    return m_active;
+}
+
+qint64 M3uImporter::fingerprint(const QString& tvg_name, const QString& tvg_id, const QString& group_title,
+                                const QString& tvg_logo, const QString& url, int tvg_chno)
+{
+    // 64 bit FNV-1a over the trimmed attributes, stable between runs
+    const QString fields[] = { tvg_name.trimmed(), tvg_id.trimmed(), group_title.trimmed(),
+                               tvg_logo.trimmed(), url.trimmed(), QString::number(tvg_chno) };
+
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+
+    for ( const QString &field : fields ) {
+        const ushort *c = field.utf16();
+        for ( int i = 0; i < field.size(); i++ ) {
+            hash = ( hash ^ c[i] ) * Q_UINT64_C(1099511628211);
+        }
+        hash = ( hash ^ 0x1f ) * Q_UINT64_C(1099511628211);
+    }
+
+    // 0 is the default of rows imported before fingerprints existed
+    return hash == 0 ? 1 : qint64(hash);
+}
+
+qint64 M3uImporter::itemKey(int pls_id, int extinf_id)
+{
+    return ( qint64(pls_id) << 32 ) | quint32(extinf_id);
+}
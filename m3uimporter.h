@@ -0,0 +1,90 @@
+#ifndef M3UIMPORTER_H
+#define M3UIMPORTER_H
+
+#include <QHash>
+#include <QSet>
+#include <QSqlQuery>
+#include <QElapsedTimer>
+
+#include "dbmanager.h"
+
+// Writes the stations of one m3u file into the database. Groups, playlists,
+// urls and playlist items are loaded once into memory, the inserts run through
+// prepared statements and the whole import is split into chunked transactions.
+// Every import gets its own run id. Each station carries a fingerprint of its
+// attributes, unchanged stations are skipped without any database write, only
+// new, changed and vanished ones are stamped with the run id. A changed
+// station moves to the playlist of its new group and takes its new channel
+// number as playlist position.
+
+class M3uImporter
+{
+public:
+    explicit M3uImporter(DbManager &db, int chunkSize = 5000);
+    ~M3uImporter();
+
+    bool begin();
+    bool addEntry(const QString& tvg_name, const QString& tvg_id, const QString& group_title,
+                  const QString& tvg_logo, const QString& url, int tvg_chno);
+    bool finish(bool complete);
+
+    int runId() const;
+    int entries() const;
+    int newEntries() const;
+    int changedEntries() const;
+    int vanishedEntries() const;
+    qint64 elapsed() const;
+    double entriesPerSecond() const;
+
+    static qint64 fingerprint(const QString& tvg_name, const QString& tvg_id, const QString& group_title,
+                              const QString& tvg_logo, const QString& url, int tvg_chno);
+
+private:
+    struct Station
+    {
+        int    id;
+        qint64 fingerprint;
+        int    state;
+        int    group_id;
+    };
+
+    int groupId(const QString&);
+    int playlistId(const QString&);
+    int extinfId(const QString&, const QString&, int, const QString&, const QString&, qint64, int&);
+    bool removeVanished();
+    bool addPlaylistItem(int, int, int);
+    bool movePlaylistItem(int, int, int, int);
+    bool nextChunk();
+
+    static qint64 itemKey(int pls_id, int extinf_id);
+
+    DbManager           &m_db;
+    int                 m_chunkSize;
+    bool                m_active;
+    int                 m_runId;
+
+    QHash<QString, int> m_groups;
+    QHash<int, QString> m_groupTitles;
+    QHash<QString, int> m_playlists;
+    QHash<QString, Station> m_urls;
+    QSet<qint64>        m_plsItems;
+    QSet<int>           m_seen;
+
+    QSqlQuery           m_insertGroup;
+    QSqlQuery           m_insertEXTINF;
+    QSqlQuery           m_updateEXTINF;
+    QSqlQuery           m_stampEXTINF;
+    QSqlQuery           m_insertPLS;
+    QSqlQuery           m_insertPLS_Item;
+    QSqlQuery           m_updatePLS_Item;
+    QSqlQuery           m_removePLS_Item;
+
+    int                 m_entries;
+    int                 m_newEntries;
+    int                 m_changedEntries;
+    int                 m_vanishedEntries;
+    int                 m_chunkEntries;
+    QElapsedTimer       m_timer;
+};
+
+#endif // M3UIMPORTER_H
@@ -0,0 +1,253 @@
+#include "m3uparser.h"
+
+#include <cstring>
+
+static bool startsWith(const M3uField &line, const char *prefix, int length)
+{
+    return line.size >= length && memcmp(line.data, prefix, size_t(length)) == 0;
+}
+
+static bool contains(const M3uField &line, const char *text, int length)
+{
+    for ( int i = 0; i + length <= line.size; i++ ) {
+        if ( line.data[i] == text[0] && memcmp(line.data + i, text, size_t(length)) == 0 ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+bool M3uField::equals(const char *text, int length) const
+{
+    return size == length && memcmp(data, text, size_t(length)) == 0;
+}
+
+int M3uField::toInt() const
+{
+    int  value = 0;
+    int  i = 0;
+    bool negative = false;
+
+    if ( size > 0 && ( data[0] == '-' || data[0] == '+' ) ) {
+        negative = data[0] == '-';
+        i++;
+    }
+
+    for ( ; i < size && data[i] >= '0' && data[i] <= '9'; i++ ) {
+        value = value * 10 + ( data[i] - '0' );
+    }
+
+    return negative ? -value : value;
+}
+
+void M3uAttributes::clear()
+{
+    duration = tvgName = tvgId = tvgLogo = groupTitle = tvgChno = M3uField();
+    others.clear();
+}
+
+M3uParser::M3uParser() :
+    m_data(nullptr),
+    m_size(0),
+    m_pos(0),
+    m_consumed(0),
+    m_complete(true)
+{
+}
+
+void M3uParser::setData(const char *data, qint64 size, bool complete)
+{
+    m_data = data;
+    m_size = size;
+    m_pos = 0;
+    m_complete = complete;
+    m_tags = m_station = M3uField();
+
+    // skip an utf-8 byte order mark
+    if ( m_size >= 3 && memcmp(m_data, "\xEF\xBB\xBF", 3) == 0 ) {
+        m_pos = 3;
+    }
+
+    m_consumed = m_pos;
+}
+
+qint64 M3uParser::position() const
+{
+    return m_pos;
+}
+
+qint64 M3uParser::consumed() const
+{
+    return m_consumed;
+}
+
+qint64 M3uParser::size() const
+{
+    return m_size;
+}
+
+bool M3uParser::readLine(M3uField &line)
+{
+    if ( m_pos >= m_size ) {
+        return false;
+    }
+
+    const char *begin = m_data + m_pos;
+    const char *end = static_cast<const char *>(memchr(begin, '\n', size_t(m_size - m_pos)));
+
+    if ( end == nullptr ) {
+        // wait for the rest of the line
+        if ( ! m_complete ) {
+            return false;
+        }
+        end = m_data + m_size;
+        m_pos = m_size;
+    } else {
+        m_pos = end - m_data + 1;
+    }
+
+    if ( end > begin && end[-1] == '\r' ) {
+        end--;
+    }
+
+    line = M3uField(begin, int(end - begin));
+
+    return true;
+}
+
+bool M3uParser::next(M3uEntry &entry)
+{
+    M3uField line;
+    qint64   start = m_pos;
+
+    while ( this->readLine(line) ) {
+
+        if ( contains(line, "#EXTINF", 7) ) {
+
+            // the tags are needed until the url arrives
+            m_consumed = start;
+
+            // tags up to the first comma outside of quotes, the station name behind it
+            const char *end = line.data + line.size;
+            const char *comma = nullptr;
+            bool quoted = false;
+
+            for ( const char *c = line.data; c < end && comma == nullptr; c++ ) {
+                if ( *c == '"' ) {
+                    quoted = !quoted;
+                } else if ( *c == ',' && !quoted ) {
+                    comma = c;
+                }
+            }
+
+            if ( comma == nullptr ) {
+                m_tags = line;
+                m_station = M3uField();
+            } else {
+                m_tags = M3uField(line.data, int(comma - line.data));
+                m_station = M3uField(comma + 1, int(end - comma - 1));
+            }
+
+        } else if ( startsWith(line, "http", 4) || startsWith(line, "rtp", 3) ) {
+
+            entry.tags = m_tags;
+            entry.station = m_station;
+            entry.url = line;
+
+            m_tags = m_station = M3uField();
+            m_consumed = m_pos;
+
+            return true;
+
+        } else if ( m_tags.data == nullptr ) {
+            m_consumed = m_pos;
+        }
+
+        start = m_pos;
+    }
+
+    return false;
+}
+
+bool M3uParser::parseAttributes(const M3uField &tags, M3uAttributes &attributes)
+{
+    const char *c = tags.data;
+    const char *end = tags.data + tags.size;
+
+    attributes.clear();
+
+    if ( tags.size < 8 || memcmp(c, "#EXTINF:", 8) != 0 ) {
+        return false;
+    }
+
+    c += 8;
+
+    // #EXTINF:<duration> key="value" key=value ...
+    const char *duration = c;
+    while ( c < end && !isSpace(*c) ) {
+        c++;
+    }
+    attributes.duration = M3uField(duration, int(c - duration));
+
+    while ( c < end ) {
+
+        while ( c < end && isSpace(*c) ) {
+            c++;
+        }
+
+        const char *key = c;
+        while ( c < end && *c != '=' && !isSpace(*c) ) {
+            c++;
+        }
+
+        M3uAttribute attribute;
+        attribute.key = M3uField(key, int(c - key));
+
+        if ( c < end && *c == '=' ) {
+            c++;
+
+            if ( c < end && *c == '"' ) {
+                const char *value = ++c;
+                while ( c < end && *c != '"' ) {
+                    c++;
+                }
+                attribute.value = M3uField(value, int(c - value));
+                if ( c < end ) {
+                    c++;
+                }
+            } else {
+                const char *value = c;
+                while ( c < end && !isSpace(*c) ) {
+                    c++;
+                }
+                attribute.value = M3uField(value, int(c - value));
+            }
+        }
+
+        if ( attribute.key.isEmpty() ) {
+            continue;
+        }
+
+        if ( attribute.key.equals("tvg-name", 8) ) {
+            attributes.tvgName = attribute.value;
+        } else if ( attribute.key.equals("tvg-id", 6) ) {
+            attributes.tvgId = attribute.value;
+        } else if ( attribute.key.equals("tvg-logo", 8) ) {
+            attributes.tvgLogo = attribute.value;
+        } else if ( attribute.key.equals("group-title", 11) ) {
+            attributes.groupTitle = attribute.value;
+        } else if ( attribute.key.equals("tvg-chno", 8) ) {
+            attributes.tvgChno = attribute.value;
+        } else {
+            attributes.others.append(attribute);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef M3UPARSER_H
+#define M3UPARSER_H
+
+#include <QString>
+#include <QVarLengthArray>
+
+// A view into the parsed buffer, only converted into a QString on demand.
+
+struct M3uField
+{
+    const char *data;
+    int         size;
+
+    M3uField() : data(nullptr), size(0) {}
+    M3uField(const char *d, int s) : data(d), size(s) {}
+
+    bool    isEmpty() const { return size == 0; }
+    bool    equals(const char *text, int length) const;
+    int     toInt() const;
+    QString toString() const { return QString::fromUtf8(data, size); }
+};
+
+struct M3uAttribute
+{
+    M3uField key;
+    M3uField value;
+};
+
+// The attributes of an #EXTINF line, the well known keys get their own field,
+// everything else ends up in others.
+
+struct M3uAttributes
+{
+    M3uField duration;
+    M3uField tvgName;
+    M3uField tvgId;
+    M3uField tvgLogo;
+    M3uField groupTitle;
+    M3uField tvgChno;
+
+    QVarLengthArray<M3uAttribute, 8> others;
+
+    void clear();
+};
+
+struct M3uEntry
+{
+    M3uField tags;
+    M3uField station;
+    M3uField url;
+};
+
+// Single pass m3u parser working directly on raw bytes, e.g. a file mapped
+// with QFile::map(). Every call of next() returns the following station.
+// When the data is only the head of a stream (complete == false) a trailing
+// incomplete line is left alone, consumed() tells how many bytes may be
+// dropped before the next chunk is appended.
+
+class M3uParser
+{
+public:
+    M3uParser();
+
+    void   setData(const char *data, qint64 size, bool complete = true);
+    bool   next(M3uEntry &entry);
+
+    qint64 position() const;
+    qint64 consumed() const;
+    qint64 size() const;
+
+    static bool parseAttributes(const M3uField &tags, M3uAttributes &attributes);
+
+private:
+    bool   readLine(M3uField &line);
+
+    const char *m_data;
+    qint64      m_size;
+    qint64      m_pos;
+    qint64      m_consumed;
+    bool        m_complete;
+
+    M3uField    m_tags;
+    M3uField    m_station;
+};
+
+#endif // M3UPARSER_H
@@ -1,9 +1,101 @@
 #include "mainwindow.h"
+#include "headlessrunner.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
 #include <QTextCodec>
 
+// the command line mode never touches the gui, not even the QApplication
+static bool isHeadless(int argc, char *argv[])
+{
+    static const char *const options[] = { "--import-m3u", "--import-epg", "--export-playlist" };
+
+    for ( int i = 1; i < argc; i++ ) {
+        const QByteArray arg(argv[i]);
+
+        if ( arg == "-h" || arg == "-?" || arg == "--help" || arg == "--help-all" ) {
+            return true;
+        }
+
+        // --option value as well as --option=value
+        for ( const char *option : options ) {
+            if ( arg == option || arg.startsWith(QByteArray(option) + '=') ) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationName("Freeware");
+    QCoreApplication::setApplicationName("m3uMan");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("m3uMan command line mode");
+    parser.addHelpOption();
+
+    QCommandLineOption importM3uOption("import-m3u", "Import the m3u <file> or url.", "file");
+    QCommandLineOption importEpgOption("import-epg", "Import the xmltv <file> or url, given more than once all are refreshed at the same time.", "file");
+    QCommandLineOption hourCorrectionOption("hour-correction", "Shift the EPG times by <hours>, on top of the XMLTV time zone offsets.", "hours", "0");
+    QCommandLineOption epgFilterOption("epg-filter", "Import only the EPG of channels used by a station.");
+    QCommandLineOption epgAllowOption("epg-allow", "Comma separated channel <ids> kept by --epg-filter as well.", "ids");
+    QCommandLineOption exportPlaylistOption("export-playlist", "Export the playlist <name> into <out.m3u>.", "name");
+    QCommandLineOption dbOption("db", "Use the database <file>.", "file",
+                                QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/m3uMan.sqlite");
+
+    parser.addOption(importM3uOption);
+    parser.addOption(importEpgOption);
+    parser.addOption(hourCorrectionOption);
+    parser.addOption(epgFilterOption);
+    parser.addOption(epgAllowOption);
+    parser.addOption(exportPlaylistOption);
+    parser.addOption(dbOption);
+    parser.addPositionalArgument("out.m3u", "Target file of --export-playlist.");
+
+    parser.process(a);
+
+    if ( parser.isSet(exportPlaylistOption) && parser.positionalArguments().size() != 1 ) {
+        parser.showHelp(1);
+    }
+
+    QDir().mkpath(QFileInfo(parser.value(dbOption)).absolutePath());
+
+    HeadlessRunner runner(parser.value(dbOption));
+
+    runner.setEpgChannelFilter(parser.isSet(epgFilterOption), parser.value(epgAllowOption).split(','));
+
+    if ( parser.isSet(importM3uOption) && ! runner.importM3u(parser.value(importM3uOption)) ) {
+        return 1;
+    }
+
+    if ( parser.values(importEpgOption).size() > 1 ) {
+        if ( ! runner.refreshEpg(parser.values(importEpgOption), parser.value(hourCorrectionOption)) ) {
+            return 1;
+        }
+    } else if ( parser.isSet(importEpgOption) && ! runner.importEpg(parser.value(importEpgOption), parser.value(hourCorrectionOption)) ) {
+        return 1;
+    }
+
+    if ( parser.isSet(exportPlaylistOption) && ! runner.exportPlaylist(parser.value(exportPlaylistOption), parser.positionalArguments().at(0)) ) {
+        return 1;
+    }
+
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
+    if ( isHeadless(argc, argv) ) {
+        return runHeadless(argc, argv);
+    }
+
     QApplication a(argc, argv);
 
     QCoreApplication::setOrganizationName("Freeware");
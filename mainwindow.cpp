@@ -26,6 +26,24 @@ MainWindow::MainWindow(QWidget *parent) :
 
     settings.setValue("BackupOnStart", 0);
 
+    // the time zone offsets of XMLTV times are applied now, an hour correction
+    // saved for them before would shift the programmes twice, so it is reset once
+    if ( settings.value("EpgOffsetsApplied").toInt() != 1 ) {
+
+        for ( int i = 1; i <= 5; i++ ) {
+
+            const QString key = QString("EPG%1").arg(i);
+            const QString value = settings.value(key).toString();
+
+            if ( value.contains(";") && value.section(';', 1, 1).toInt() != 0 ) {
+                qDebug() << "reset the EPG hour correction of" << key << value;
+                settings.setValue(key, value.section(';', 0, 0) + ";0");
+            }
+        }
+
+        settings.setValue("EpgOffsetsApplied", 1);
+    }
+
     db.open(m_AppDataPath + "/m3uMan.sqlite");
 
     if (db.isOpen()) {
@@ -36,6 +54,8 @@ MainWindow::MainWindow(QWidget *parent) :
         qDebug() << "Database is not open!";
     }
 
+    m_epgCache = new EpgCache(db);
+
     _instance = new VlcInstance(VlcCommon::args(), this);
 
     _player = new VlcMediaPlayer(_instance);
@@ -121,6 +141,29 @@ MainWindow::MainWindow(QWidget *parent) :
     createActions();
     createStatusBar();
 
+    m_importWorker = new ImportWorker(m_AppDataPath + "/m3uMan.sqlite");
+    m_importWorker->moveToThread(&m_importThread);
+
+    connect(&m_importThread, SIGNAL(finished()), m_importWorker, SLOT(deleteLater()));
+    connect(this, SIGNAL(startM3uImport(QString)), m_importWorker, SLOT(importM3u(QString)));
+    connect(this, SIGNAL(startM3uDownload(QString,QString)), m_importWorker, SLOT(importM3uUrl(QString,QString)));
+    connect(this, SIGNAL(epgChannelFilter(bool,QStringList)), m_importWorker, SLOT(setEpgChannelFilter(bool,QStringList)));
+    connect(this, SIGNAL(startEpgImport(QString,QString)), m_importWorker, SLOT(importEpg(QString,QString)));
+    connect(this, SIGNAL(startEpgDownload(QString,QString,QString)), m_importWorker, SLOT(importEpgUrl(QString,QString,QString)));
+    connect(this, SIGNAL(startEpgRefresh(QStringList,QString)), m_importWorker, SLOT(refreshEpgSources(QStringList,QString)));
+    connect(m_importWorker, SIGNAL(progress(int,int,QString)), this, SLOT(importProgress(int,int,QString)));
+    connect(m_importWorker, SIGNAL(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)), this, SLOT(m3uImportFinished(int,int,int,int,int,int,double,bool,bool)));
+    connect(m_importWorker, SIGNAL(m3uDownloadFailed(QString)), this, SLOT(m3uDownloadFailed(QString)));
+    connect(m_importWorker, SIGNAL(epgImportFinished(int,int,double,QString,bool)), this, SLOT(epgImportFinished(int,int,double,QString,bool)));
+    connect(m_importWorker, SIGNAL(epgSourceFinished(QString,int,qint64,QString)), this, SLOT(epgSourceFinished(QString,int,qint64,QString)));
+
+    m_importThread.start();
+
+    m_actualProgramsPlsId = 0;
+    m_actualProgramsTimer.setSingleShot(true);
+
+    connect(&m_actualProgramsTimer, SIGNAL(timeout()), this, SLOT(refreshActualPrograms()));
+
     fillComboGroupTitels();
     fillComboEPGChannels();
 
@@ -317,6 +360,11 @@ void MainWindow::closeEvent(QCloseEvent *event)
 
 MainWindow::~MainWindow()
 {
+    m_importWorker->cancel();
+    m_importThread.quit();
+    m_importThread.wait();
+
+    delete m_epgCache;
     delete ui;
 }
 
@@ -452,7 +500,7 @@ void MainWindow::on_edtLoad_clicked() {
 
     QString fileName = QFileDialog::getOpenFileName(this, ("Open m3u File"),
                                                      m_AppDataPath,
-                                                     ("m3u Listen (*.m3u)"));
+                                                     ("m3u Listen (*.m3u *.m3u.gz *.m3u.xz)"));
 
     if ( !fileName.isNull() ) {
         qDebug() << "selected file path : " << fileName.toUtf8();
@@ -462,229 +510,28 @@ void MainWindow::on_edtLoad_clicked() {
 
 void MainWindow::getFileData(const QString &filename)
 {
-    int counter = 0;
-    int linecount = 0;
-    bool ende = false;
-    int newfiles = 0;
-
-    QString tags;
-    QString station;
-    QString url;
-    QStringList parser;
-
-    QString tvg_name;
-    QString tvg_id;
-    QString tvg_chno;
-    QString group_title, last_group_title;
-    int     group_id, pls_id, plsi_id, extinf_id;
-    QString tvg_logo;
-
-    bool overwrite = false;
-
-    QSqlQuery *query = nullptr;
-
-    QFile file(filename);
-
-    if(!file.exists()){
-        qDebug() << "File <i>cannot</i> be found "<<filename;
-    }
-
-    QString line;
-
-    db.deactivateEXTINFs();
-
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)){
-
-        QTextStream stream(&file);
-        stream.setCodec("UTF-8");
-
-        statusBar()->showMessage(tr("preparing data..."));
-
-        while (!stream.atEnd()){
-
-            line = stream.readLine();
-
-            if ( line.startsWith("http") or line.startsWith("rtp") ) {
-              linecount++;
-            }
-        }
-
-        qDebug() << "Lines" << linecount;
-
-        statusBar()->repaint();
-
-        m_progress->setMinimum(0);
-        m_progress->setMaximum(linecount);
-        m_progress->setVisible(true);
-        m_progressCancel->setVisible(true);
-        m_ProgressWasCanceled = false;
-
-#ifdef Q_OS_WIN
-        taskbarProgress->setMinimum(0);
-        taskbarProgress->setMaximum(linecount);
-        taskbarProgress->setVisible(true);
-#endif
-
-        stream.seek(0);
-
-        while (!stream.atEnd() && !ende){
-
-            line = stream.readLine();
-
-            if (m_ProgressWasCanceled)
-                ende = true;
-
-            if ( line.contains("#EXTINF") ) {
-
-                tags = line.split(",").at(0);
-                station = line.split(",").at(1);
-
-            } else if ( line.startsWith("http") or line.startsWith("rtp") ) {
-
-                url = line;
-
-                parser = this->splitCommandLine(tags);
-
-                tvg_name = station;
-                group_title = "NoGroup";
-                tvg_logo = " ";
-                tvg_chno = "0";
-
-                foreach(QString item, parser) {
-
-                    if ( item.contains("tvg-name") ) {
-                        tvg_name = item.split("=").at(1);
-                    }
-                    else if ( item.contains("tvg-id") ) {
-                        tvg_id = item.split("=").at(1);
-                    }
-                    else if ( item.contains("group-title") ) {
-                        group_title = item.split("=").at(1);
-                    }
-                    else if ( item.contains("tvg-logo") ) {
-                        tvg_logo = item.split("=").at(1);
-                    }
-                    else if ( item.contains("tvg-chno") ) {
-                        tvg_chno = item.split("=").at(1);
-                    }
-                }
-
-                // ------------------------------------------------
-                query = db.selectGroup_byTitle(group_title);
-                query->last();
-                query->first();
-
-                if ( query->isValid() ) {
-                    group_id = query->value(0).toByteArray().toInt();
-                } else {
-                    group_id = db.addGroup(group_title);
-                }
-
-                delete query;
-
-                // ------------------------------------------------
-                query = db.selectEXTINF_byUrl(url);
-
-                query->last();
-                query->first();
-
-                if ( query->isValid() ) {
-
-                    extinf_id = query->value(0).toByteArray().toInt();
-
-                    if ( overwrite ) {
+    this->setImportRunning(true);
 
-                        if ( ! db.updateEXTINF_byRef(extinf_id, tvg_name, group_id, tvg_logo, 1 ) ) {
-                            qDebug() << "-E-" << "updateEXTINF_byRef" <<tvg_name<< tvg_id<< group_title<< tvg_logo<< url;
-                        }
-                    }
-                } else {
-
-                    extinf_id = db.insertEXTINF(tvg_name, tvg_id, group_id, tvg_logo, url)                    ;
-
-                    if ( extinf_id == 0 ) {
-                        qDebug() << "-E-" << "addEXTINF" << tvg_name<< tvg_id<< group_title<< tvg_logo<< url;
-                    }
-                    newfiles++;
-                }
-
-                delete query;
-
-                // ------------------------------------------------
-                // Playlist anlegen
-                // ------------------------------------------------
-                query = db.selectPLS_by_pls_name(group_title);
-
-                query->last();
-                query->first();
-
-                if ( query->isValid() ) {
-                    pls_id = query->value(0).toByteArray().toInt();
-                } else {
-                    pls_id = db.insertPLS(group_title, 0);
-                }
-
-                delete query;
-
-                // ------------------------------------------------
-                // Playlist Item anlegen
-                // ------------------------------------------------
-                query = db.selectPLS_Items_by_key(pls_id, extinf_id);
-
-                query->last();
-                query->first();
-
-                if ( ! query->isValid() ) {
-
-                    plsi_id = db.insertPLS_Item( pls_id, extinf_id, tvg_chno.toInt() );
-
-                    if ( plsi_id == 0 ) {
-                        qDebug() << "-E-" << "insertPLS_Item" << pls_id<< extinf_id<< tvg_chno.toInt();
-                    }
-                }
-
-                delete query;
-                // ------------------------------------------------
-
-                counter++;
-
-                if ( counter % 100 == 0 ) {
-                    statusBar()->showMessage(tr("%1 stations").arg(counter));                    
-                }
-
-                QCoreApplication::processEvents();
+    statusBar()->showMessage(tr("import %1...").arg(filename));
 
-                m_progress->setValue(counter);
-#ifdef Q_OS_WIN
-                taskbarProgress->setValue(counter);
-#endif
-            }
-        }
-    }
+    emit startM3uImport(filename);
+}
 
-    file.close();
+void MainWindow::m3uImportFinished(int stations, int newStations, int changedStations, int vanishedStations,
+                                   int obsolete, int runId, double entriesPerSecond, bool canceled, bool complete)
+{
+    this->setImportRunning(false);
 
-#ifdef Q_OS_WIN
-    taskbarProgress->setVisible(false);
-#endif
-    m_progress->setVisible(false);
-    m_progressCancel->setVisible(false);
+    statusBar()->showMessage(tr("%1 stations imported%2: %3 new, %4 changed, %5 vanished, %6 obsolete (%7 entries/s)")
+                             .arg(stations)
+                             .arg(canceled ? tr(", canceled") : complete ? QString() : tr(", incomplete"))
+                             .arg(newStations)
+                             .arg(changedStations)
+                             .arg(vanishedStations)
+                             .arg(obsolete)
+                             .arg(entriesPerSecond, 0, 'f', 0));
+    Q_UNUSED(runId)
 /*
-    QSqlQuery *test;
-
-    test = db.countEXTINF_byState();
-
-    while ( test->next() ) {
-
-        qDebug() << "obsolete" << test->value(0).toByteArray().constData() << test->value(1).toByteArray().constData();
-
-        if( test->value(0).toByteArray().toInt() == 0 ) {
-            obsolete = test->value(1).toByteArray().toInt();
-        }
-    }
-
-    delete test;
-
     if ( obsolete > 0 ) {
 
         QMessageBox::StandardButton reply;
@@ -693,12 +540,12 @@ void MainWindow::getFileData(const QString &filename)
 
         if (reply == QMessageBox::Yes) {
 
-            db.removeObsoleteEXTINFs();
+            db.removeObsoleteEXTINFs(runId);
         }
     }
 */
-    if ( newfiles > 0 ) {
-        QMessageBox::information(this, "m3uMan", QString("%1 new stations added!").arg(newfiles), QMessageBox::Ok);
+    if ( newStations > 0 ) {
+        QMessageBox::information(this, "m3uMan", QString("%1 new stations added!").arg(newStations), QMessageBox::Ok);
     }
 
     fillComboGroupTitels();
@@ -706,99 +553,54 @@ void MainWindow::getFileData(const QString &filename)
     fillComboPlaylists();
 }
 
-QStringList MainWindow::splitCommandLine(const QString & cmdLine)
-{
-    QStringList list;
-    QString arg;
-
-    bool escape = false;
-    enum { Idle, Arg, QuotedArg } state = Idle;
-
-    foreach (QChar const c, cmdLine) {
-        if (!escape && c == '\\') { escape = true; continue; }
-        switch (state) {
-        case Idle:
-            if (!escape && c == '"') state = QuotedArg;
-            else if (escape || !c.isSpace()) { arg += c; state = Arg; }
-            break;
-        case Arg:
-            if (!escape && c == '"') state = QuotedArg;
-            else if (escape || !c.isSpace()) arg += c;
-            else { list << arg; arg.clear(); state = Idle; }
-            break;
-        case QuotedArg:
-            if (!escape && c == '"') state = arg.isEmpty() ? Idle : Arg;
-            else arg += c;
-            break;
-        }
-        escape = false;
-    }
-    if (!arg.isEmpty()) list << arg;
-    return list;
+void MainWindow::m3uDownloadFailed(const QString &error)
+{
+    QMessageBox(QMessageBox::Critical, "Downloader", tr("Download fails: %1").arg(error), QMessageBox::Ok).exec() ;
 }
 
-QTreeWidgetItem* MainWindow::addTreeRoot(const QString& name, const QString& description, const QString& id, int favorite)
+void MainWindow::importProgress(int value, int maximum, const QString &message)
 {
-    QTreeWidgetItem *treeItem = new QTreeWidgetItem(ui->treeWidget);
-
-    treeItem->setText(0, name);
-    treeItem->setText(1, description);
-    treeItem->setText(2, id);
+    m_progress->setMaximum(maximum);
+    m_progress->setValue(value);
+    m_progress->setVisible(maximum > 0);
 
-    if ( favorite == 1 ) {
-         treeItem->setBackground(0, QColor("orange") );
-    }
+#ifdef Q_OS_WIN
+    taskbarProgress->setMaximum(maximum);
+    taskbarProgress->setValue(value);
+#endif
 
-    return treeItem;
+    statusBar()->showMessage(message);
 }
 
-void MainWindow::addTreeChild(QTreeWidgetItem *parent, const QString& name, const QString& description, const QString& id, const QString& used, const QString& state, const QString& url, const QString& logo)
+void MainWindow::setImportRunning(bool running)
 {
-    QTreeWidgetItem *treeItem = new QTreeWidgetItem();
-
-    treeItem->setText(0, name);
-    treeItem->setText(1, description);
-
-    if ( state.toInt() == 1 ) {
-         treeItem->setBackground(2, QColor("#FFCCCB") ); // light red (active stream )
-    } else if ( state.toInt() == 2 ) {
-         treeItem->setBackground(2, QColor("#90ee90") ); // light green (new stream)
-    }
-
-    treeItem->setText(2, id);
-    treeItem->setData(Qt::UserRole, 0, url);
+    ui->edtLoad->setEnabled(!running);
+    ui->edtDownload->setEnabled(!running);
+    ui->cmdImportEpg->setEnabled(!running);
+    ui->edtEPGDownload->setEnabled(!running);
+    ui->actionimport_m3u_file->setEnabled(!running);
+    ui->actionRefresh_all_EPG_sources->setEnabled(!running);
 
-    treeItem->setText(3, logo);
-
-    treeItem->setStatusTip(0, tr("double click to add the station to the selected playlist"));
-
-    if ( used.toInt() > 0 ) {
-        treeItem->setBackground(0, QColor("#4CAF50") );
-    }
-
-    parent->addChild(treeItem);
+    m_progress->setMinimum(0);
+    m_progress->setMaximum(0);
+    m_progress->setValue(0);
+    m_progress->setVisible(running);
+    m_progressCancel->setVisible(running);
 
+#ifdef Q_OS_WIN
+    taskbarProgress->setMinimum(0);
+    taskbarProgress->setMaximum(0);
+    taskbarProgress->setVisible(running);
+#endif
 }
 
 void MainWindow::fillTreeWidget()
 {
-    QString group, lastgroup;
-    QString title;
-    QString id;
-    QString tvg_id, tvg_logo;
-    QString used;
+    QString group;
     QString state;
-    QString url;
     QString favorite;
-    QString group_id;
 
-    // Add root nodes
-    QTreeWidgetItem *item = nullptr;
-    QSqlQuery *select = nullptr;
-
-    ui->treeWidget->clear();
-    ui->treeWidget->setColumnCount(4);
-    ui->treeWidget->setHeaderLabels(QStringList() << "Group" << "Station" << "ID" << "Logo");
+    std::vector<ExtinfRow> stations;
 
     if ( ui->cboGroupTitels->currentText().isEmpty() ) {
         group = "%EU |%";
@@ -824,44 +626,14 @@ void MainWindow::fillTreeWidget()
         favorite = "0";
     }
 
-    select = db.selectEXTINF(group, ui->edtFilter->text(), state, favorite.toInt() );
-
-    ui->treeWidget->blockSignals(true);
-
-    while ( select->next() ) {
-
-        group = select->value(8).toByteArray().constData();
-
-        if (group.isEmpty()) {
-            group = " ";
-        }
-
-        title = select->value(1).toByteArray().constData();
-        tvg_id = select->value(2).toByteArray().constData();
-        tvg_logo = select->value(4).toByteArray().constData();
-        id = select->value(0).toByteArray().constData();
-        group_id = select->value(3).toByteArray().constData();
-        url = select->value(5).toByteArray().constData();
-        used = select->value(10).toByteArray().constData();
-        state = select->value(6).toByteArray().constData();
-        favorite = select->value(9).toByteArray().constData();
-
-        if ( group != lastgroup ) {
-            item = addTreeRoot(group, "", group_id, favorite.toInt());
-            lastgroup = group;
-        }
-
-        addTreeChild(item, title, tvg_id, id, used, state, url, tvg_logo);
-    }
-
-    ui->treeWidget->blockSignals(false);
+    db.selectEXTINF(group, ui->edtFilter->text(), state, favorite.toInt(), stations);
 
-    delete select;
+    StationTree(ui->treeWidget).populate(stations);
 }
 
 void MainWindow::fillComboPlaylists()
 {
-    QSqlQuery *select = nullptr;
+    DbCursor select;
     QString title;
     QString id;
     int     favorite = 0;
@@ -882,8 +654,6 @@ void MainWindow::fillComboPlaylists()
         ui->cboPlaylists->addItem(title, id);
     }
 
-    delete select;
-
     ui->cmdDeletePlaylist->setEnabled( ui->cboPlaylists->count() != 0 );
     ui->cmdRenamePlaylist->setEnabled( ui->cboPlaylists->count() != 0 );   
     ui->cmdAddToFavorits->setEnabled( ui->cboPlaylists->count() != 0 );
@@ -892,7 +662,7 @@ void MainWindow::fillComboPlaylists()
 
 void MainWindow::fillComboGroupTitels()
 {
-    QSqlQuery *select = nullptr;
+    DbCursor select;
     QString title;
     QString id;
     int favorite = 0;
@@ -911,8 +681,6 @@ void MainWindow::fillComboGroupTitels()
 
         ui->cboGroupTitels->addItem(title, id);
     }
-
-    delete select;
 }
 
 void MainWindow::on_cmdNewPlaylist_clicked()
@@ -989,11 +757,8 @@ void MainWindow::on_treeWidget_itemDoubleClicked(QTreeWidgetItem *item, int colu
 
 void MainWindow::fillTwPls_Item()
 {
-    QString id;
-    QString extinf_id;
-    QString tvg_name, tvg_id, pls_pos;
+    QString tvg_name;
     QString logo;
-    QString url;
     bool    added = false;
     QFile   file;
     QPixmap buttonImage, topImage;
@@ -1010,7 +775,7 @@ void MainWindow::fillTwPls_Item()
     int pls_id = ui->cboPlaylists->itemData(ui->cboPlaylists->currentIndex()).toString().toInt();
 
     // Add root nodes
-    QSqlQuery *select, *select2 = nullptr;
+    DbCursor select;
 
     select = db.selectPLS_by_id(pls_id);
 
@@ -1021,8 +786,6 @@ void MainWindow::fillTwPls_Item()
         kind = select->value(3).toByteArray().toInt();
     }
 
-    delete select;
-
     switch (kind) {
         case 1 : ui->radTv->setChecked(true);
                  ui->cmdImdb->setVisible(false);
@@ -1067,35 +830,31 @@ void MainWindow::fillTwPls_Item()
         onlyEpg = 1;
     }
 
-    select = db.selectPLS_Items(pls_id, tvg_name, onlyEpg);
-    while ( select->next() ) {
+    this->loadActualPrograms(pls_id);
 
-        id = select->value(0).toByteArray().constData();
-        extinf_id = select->value(2).toByteArray().constData();
-        pls_pos = select->value(3).toByteArray().constData();
-        favorite = select->value(5).toByteArray().toInt();
-        logo = select->value(10).toByteArray().constData();
-        tvg_name = select->value(7).toByteArray().constData();
-        tvg_id = select->value(8).toByteArray().constData();
-        url = select->value(11).toByteArray().constData();
-
-        program.clear();
-        select2 = db.selectActualProgramData(tvg_id);
-        while ( select2->next() ) {
-            program = select2->value(4).toByteArray().constData();
-        }
+    std::vector<PlsItemRow> items;
+
+    db.selectPLS_Items(pls_id, tvg_name, onlyEpg, items);
 
-        delete select2;
+    for ( size_t i = 0; i < items.size(); i++ ) {
+
+        const PlsItemRow &row = items[i];
+
+        favorite = row.favorite;
+        logo = row.tvg_logo;
+        tvg_name = row.tvg_name;
+
+        program = m_actualPrograms.value(row.tvg_id);
 
         QTreeWidgetItem *treeItem = new QTreeWidgetItem(ui->twPLS_Items);
 
-        treeItem->setText(0, QString("%1").arg(pls_pos.toInt() + 1) );
+        treeItem->setText(0, QString("%1").arg(row.pls_pos + 1) );
         treeItem->setText(1, tvg_name);
-        treeItem->setText(2, tvg_id);
+        treeItem->setText(2, row.tvg_id);
         treeItem->setText(3, program);
 
-        treeItem->setData(0, Qt::UserRole, id);
-        treeItem->setData(0, Qt::UserRole+1, extinf_id);
+        treeItem->setData(0, Qt::UserRole, row.id);
+        treeItem->setData(0, Qt::UserRole+1, row.extinf_id);
         treeItem->setStatusTip(0, tr("double click to remove the station"));
 
         if ( QUrl(logo).fileName().isEmpty() ) {
@@ -1166,20 +925,50 @@ void MainWindow::fillTwPls_Item()
 
         if ( favorite == 1 ) {
             action = new QAction(QIcon(buttonImage.scaled(100,100,Qt::KeepAspectRatio, Qt::SmoothTransformation)), tvg_name);
-            action->setData(select->at());
+            action->setData(int(i));
             ui->mainToolBar->addAction(action);
         }
 
         added = true;
     }
 
-    delete select;
-
     ui->cmdMoveUp->setEnabled( added );
     ui->cmdMoveDown->setEnabled( added );
     ui->edtStationUrl->setText("");
 }
 
+void MainWindow::loadActualPrograms(int pls_id)
+{
+    std::vector<ProgramRow> programs;
+    qint64                  now = QDateTime::currentDateTimeUtc().toSecsSinceEpoch();
+    qint64                  next = now + 15 * 60;
+
+    m_actualProgramsPlsId = pls_id;
+    m_actualPrograms.clear();
+
+    db.selectActualProgramData_byPls(pls_id, programs);
+
+    for ( const ProgramRow &program : programs ) {
+        m_actualPrograms.insert(program.channel, program.title);
+        next = qMin(next, program.stop);
+    }
+
+    // wake up when the first of the running programmes is over
+    m_actualProgramsTimer.start(int(qMax<qint64>(1, next - now + 1) * 1000));
+}
+
+void MainWindow::refreshActualPrograms()
+{
+    QTreeWidgetItem *item;
+
+    this->loadActualPrograms(m_actualProgramsPlsId);
+
+    for(int i=0;i<ui->twPLS_Items->topLevelItemCount();++i) {
+        item = ui->twPLS_Items->topLevelItem(i);
+        item->setText(3, m_actualPrograms.value(item->text(2)));
+    }
+}
+
 void MainWindow::on_cboPlaylists_currentTextChanged(const QString &arg1)
 {
     ui->lblLogo->clear();
@@ -1288,8 +1077,6 @@ void MainWindow::MakeLogoUrlList()
 {
     QTreeWidgetItem *item;
     int             extinf_id;
-    QSqlQuery       *select;
-    QString         logo,title;
     QDir            dir;
     bool            ok = false;
 
@@ -1319,19 +1106,12 @@ void MainWindow::MakeLogoUrlList()
         item = ui->twPLS_Items->topLevelItem(i);
         extinf_id = item->data(0, Qt::UserRole+1).toInt();
 
-        select = db.selectEXTINF_byRef(extinf_id);
-        while ( select->next() ) {
-
-            title = select->value(1).toByteArray().constData();
-            logo = select->value(4).toByteArray().constData();
+        ExtinfRow station;
 
-            if ( ! logo.isEmpty() ) {
-                out << QString("%1,%2\n").arg(title, logo);
-            }
+        if ( db.selectEXTINF_byRef(extinf_id, station) && ! station.tvg_logo.isEmpty() ) {
+            out << QString("%1,%2\n").arg(station.tvg_name, station.tvg_logo);
         }
 
-        delete select;
-
         QGuiApplication::restoreOverrideCursor();
     }
 
@@ -1347,15 +1127,7 @@ void MainWindow::MakeLogoUrlList()
 
 void MainWindow::MakePlaylist()
 {
-    QTreeWidgetItem *item;
-    int             extinf_id;
-    QSqlQuery       *select;
-    QString         group;
-    QString         title;
-    QString         id;
-    QString         tvg_id;
-    QString         logo;
-    QString         url;
+    QList<int>      extinf_ids;
     QDir            dir;
     bool            ok = false;
 
@@ -1369,47 +1141,23 @@ void MainWindow::MakePlaylist()
         return;
     }
 
-    QFile file( fileName );
-
-    if(!file.open(QFile::WriteOnly | QFile::Text)) {
-        qDebug() << "Could not open file '" + fileName + "' for writing";
-        return;
+    for(int i=0;i<ui->twPLS_Items->topLevelItemCount();++i) {
+        extinf_ids << ui->twPLS_Items->topLevelItem(i)->data(0, Qt::UserRole+1).toInt();
     }
 
     QGuiApplication::setOverrideCursor(Qt::WaitCursor);
 
-    QTextStream out(&file);
-
-    out << "#EXTM3U\n";
-
-    for(int i=0;i<ui->twPLS_Items->topLevelItemCount();++i) {
-
-        item = ui->twPLS_Items->topLevelItem(i);
-        extinf_id = item->data(0, Qt::UserRole+1).toInt();
-
-        select = db.selectEXTINF_byRef(extinf_id);
-        while ( select->next() ) {
-
-            id = select->value(0).toByteArray().constData();
-            title = select->value(1).toByteArray().constData();
-            tvg_id = select->value(2).toByteArray().constData();
-            group = select->value(8).toByteArray().constData();
-            logo = select->value(4).toByteArray().constData();
-            url = select->value(5).toByteArray().constData();
-
-            group = ui->cboPlaylists->currentText();
+    M3uExporter exporter(db);
 
-            out << QString("#EXTINF:-1 tvg-chno=\"%6\" tvg-name=\"%1\" tvg-id=\"%2\" group-title=\"%3\" tvg-logo=\"%4\",%1\n%5\n").arg(title).arg(tvg_id).arg(group).arg(logo).arg(url).arg(i+1);
-        }
+    ok = exporter.exportStations(extinf_ids, ui->cboPlaylists->currentText(), fileName);
 
-        delete select;
+    QGuiApplication::restoreOverrideCursor();
 
-        QGuiApplication::restoreOverrideCursor();
+    if ( ! ok ) {
+        qDebug() << exporter.errorString();
+        return;
     }
 
-    file.flush();
-    file.close();
-
     somethingchanged = false;
 
     QMessageBox::information(this, "m3uMan", tr("Export playlist <b>%1</b> done...").arg(fileName), QMessageBox::Ok);
@@ -1437,6 +1185,20 @@ void MainWindow::on_edtDownload_clicked()
 
         QUrl imageUrl(ui->edtUrl->text());
 
+        // download and import at the same time, the file is written alongside
+        if (ui->chkImport->isChecked() ) {
+
+            const QString timestamp = QDateTime::currentDateTime().toString(QLatin1String("yyyyMMddhhmmss"));
+            const QString filename = m_AppDataPath + "/" + QString::fromLatin1("/iptv-%1.m3u").arg(timestamp);
+
+            this->setImportRunning(true);
+
+            statusBar()->showMessage(tr("download and import %1...").arg(imageUrl.toString()));
+
+            emit startM3uDownload(imageUrl.toString(), filename);
+            return;
+        }
+
         m_pImgCtrl = new FileDownloader(imageUrl, this);
 
         connect(m_pImgCtrl, SIGNAL (downloaded()), this, SLOT (SaveM3u()));
@@ -1482,14 +1244,24 @@ void MainWindow::SaveXML()
     const QDateTime now = QDateTime::currentDateTime();
     const QString timestamp = now.toString(QLatin1String("yyyyMMddhhmmss"));
 
-    const QString filename = m_AppDataPath + "/" + QString::fromLatin1("/epg-%1.xml").arg(timestamp);
+    QString filename = m_AppDataPath + "/" + QString::fromLatin1("/epg-%1.xml").arg(timestamp);
+
+    // keep the download compressed, the import unpacks it on the fly
+    const QByteArray data = m_pImgCtrl->downloadedData();
+    const StreamDecompressor::Format format = StreamDecompressor::detect(data.constData(), data.size());
+
+    if ( format == StreamDecompressor::Gzip ) {
+        filename += ".gz";
+    } else if ( format == StreamDecompressor::Xz ) {
+        filename += ".xz";
+    }
 
     QFile newDoc(filename);
 
-    if ( m_pImgCtrl->downloadedData().size() > 0 ) {
+    if ( data.size() > 0 ) {
         if(newDoc.open(QIODevice::WriteOnly)){
 
-            newDoc.write(m_pImgCtrl->downloadedData());
+            newDoc.write(data);
             newDoc.close();
 
             QString sHourCorrection = m_pImgCtrl->getData();
@@ -1509,7 +1281,6 @@ void MainWindow::SaveXML()
 
 void MainWindow::on_twPLS_Items_itemSelectionChanged()
 {
-    QSqlQuery *select;
     QString   group;
     QString   title;
     QString   id;
@@ -1531,27 +1302,23 @@ void MainWindow::on_twPLS_Items_itemSelectionChanged()
 
         int extinf_id = mitem->data(0, Qt::UserRole+1).toInt();
 
-        select = db.selectEXTINF_byRef(extinf_id);
-        while ( select->next() ) {
+        ExtinfRow station;
 
-            id = select->value(0).toByteArray().constData();
-            title = select->value(1).toByteArray().constData();
-            tvg_id = select->value(2).toByteArray().constData();
-            group = select->value(3).toByteArray().constData();
-            logo = select->value(4).toByteArray();
-            url = select->value(5).toByteArray().constData();
+        if ( db.selectEXTINF_byRef(extinf_id, station) ) {
+            id = QString::number(station.id);
+            title = station.tvg_name;
+            tvg_id = station.tvg_id;
+            group = QString::number(station.group_id);
+            logo = station.tvg_logo;
+            url = station.url;
         }
 
-        delete select;
-
-        select = db.selectPLS_Items_by_extinf_id(extinf_id);
+        DbCursor select = db.selectPLS_Items_by_extinf_id(extinf_id);
         while ( select->next() ) {
 
             tmdb_id = select->value(4).toByteArray().constData();
         }
 
-        delete select;
-
         if ( tvg_id.trimmed().isEmpty() ) {
             ui->cboEPGChannels->setCurrentText(" ");
             ui->cmdEPG->setEnabled(false);
@@ -1581,20 +1348,17 @@ void MainWindow::on_twPLS_Items_itemSelectionChanged()
 
             ui->cmdImdb->setEnabled(false);
 
-            select = db.selectActualProgramData(tvg_id);
-
-            while ( select->next() ) {
+            const EpgEntry *actual = m_epgCache->actual(tvg_id, QDateTime::currentDateTimeUtc().toSecsSinceEpoch());
 
-                title = select->value(4).toByteArray().constData();
-                desc = select->value(5).toByteArray().constData();
+            if ( actual != nullptr ) {
+                title = m_epgCache->text(actual->title);
+                desc = m_epgCache->text(actual->desc);
             }
 
             ui->edtOutput->clear();
             ui->edtOutput->append(title);
             ui->edtOutput->append("");
             ui->edtOutput->append(desc);
-
-            delete select;
         }
 
         if ( ! logo.trimmed().isEmpty() ) { // z.B.: https://lo1.in/ger/dsr.png
@@ -1811,7 +1575,7 @@ void MainWindow::on_cmdImportEpg_clicked()
 
     QString sFileName = QFileDialog::getOpenFileName(this, ("Open xmp program File"),
                                                      m_AppDataPath,
-                                                     ("xml program file (*.xml)"));
+                                                     ("xml program file (*.xml *.xml.gz *.xml.xz)"));
 
     if ( !sFileName.isNull() ) {
         qDebug() << "selected file path : " << sFileName.toUtf8();
@@ -1827,109 +1591,88 @@ void MainWindow::on_cmdImportEpg_clicked()
 
 void MainWindow::getEPGFileData(const QString &sFileName, const QString &sHourCorrection )
 {
-    QFile   *xmlFile;
-    QXmlStreamReader *xmlReader;
-    int     linecount=0;
-    QString line;
-    bool    ende = false;
+    this->setImportRunning(true);
 
-    QString start, stop, channel, title, desc;
+    statusBar()->showMessage(tr("import %1...").arg(sFileName));
 
-    db.removeOldPrograms();
+    this->emitEpgChannelFilter();
 
-    m_progress->setMinimum(0);
-    m_progress->setMaximum(0);
-    m_progress->setVisible(false);
-    m_progressCancel->setVisible(true);
-    m_ProgressWasCanceled = false;
-
-#ifdef Q_OS_WIN
-    taskbarProgress->setMinimum(0);
-    taskbarProgress->setMaximum(0);
-    taskbarProgress->setVisible(true);
-#endif
-
-    xmlFile = new QFile(sFileName);
+    emit startEpgImport(sFileName, sHourCorrection);
+}
 
-    if (!xmlFile->open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QMessageBox::critical(this,"Load XML File Problem",
-            tr("Couldn't open %1 to load settings for download").arg(sFileName),
-            QMessageBox::Ok);
-            return;
-    }
+void MainWindow::emitEpgChannelFilter()
+{
+    // EpgChannelFilter=1 keeps the programmes of the channels in use only
+    QSettings settings(m_SettingsFile, QSettings::IniFormat);
 
-    xmlReader = new QXmlStreamReader(xmlFile);
+    emit epgChannelFilter(settings.value("EpgChannelFilter").toInt() == 1,
+                          settings.value("EpgChannelAllowList").toString().split(","));
+}
 
-    //Parse the XML until we reach end of it
-    while ( !xmlReader->atEnd() && !xmlReader->hasError() && !ende ) {
+void MainWindow::epgImportFinished(int programs, int duplicates, double programsPerSecond, const QString &error, bool canceled)
+{
+    this->setImportRunning(false);
 
-            if (m_ProgressWasCanceled)
-               ende = true;
+    const QString report = m_epgRefreshReport.join("\n");
+    m_epgRefreshReport.clear();
 
-            // Read next element
-            QXmlStreamReader::TokenType token = xmlReader->readNext();
+    // the sources that did work are committed, so the cache is stale either way
+    m_epgCache->invalidate();
 
-            //If token is StartElement - read it
-            if ( token == QXmlStreamReader::StartElement ) {
+    this->fillComboEPGChannels();
+    this->refreshActualPrograms();
 
-                    if ( xmlReader->name() == "programme" ) {
-                        start = xmlReader->attributes().value("start").toString();
-                        stop = xmlReader->attributes().value("stop").toString();
-                        channel = xmlReader->attributes().value("channel").toString();
-                    } else if ( xmlReader->name() == "title" ) {
-                        title = xmlReader->readElementText();
-                    } else if ( xmlReader->name() == "desc" ) {
-                        desc = xmlReader->readElementText();
-                    }
-            }
+    if ( ! error.isEmpty() ) {
+        QMessageBox::critical(this, "EPG import", report.isEmpty() ? error : report, QMessageBox::Ok);
+        return;
+    }
 
-            if (token == QXmlStreamReader::EndElement) {
+    statusBar()->showMessage(tr("%1 programs imported%2, %3 duplicates skipped (%4 rows/s)").arg(programs)
+                                                                                          .arg(canceled ? tr(", canceled") : QString())
+                                                                                          .arg(duplicates)
+                                                                                          .arg(programsPerSecond, 0, 'f', 0));
 
-                if (xmlReader->name() == "programme") {
+    QMessageBox::information(this, "m3uMan", report.isEmpty() ? QString("EPG data import done...") : report, QMessageBox::Ok);
+}
 
-                    start.replace(8, 2, QString("%1").arg(start.mid(8, 2).toInt() + sHourCorrection.toInt(), 2, 10, QLatin1Char('0')));
-                    stop.replace(8, 2, QString("%1").arg(stop.mid(8, 2).toInt() + sHourCorrection.toInt(), 2, 10, QLatin1Char('0')));
+void MainWindow::epgSourceFinished(const QString &url, int programs, qint64 msecs, const QString &error)
+{
+    const QString line = error.isEmpty() ? tr("%1: %2 programs in %3 s").arg(url).arg(programs).arg(msecs / 1000.0, 0, 'f', 1)
+                                         : tr("%1: %2").arg(url).arg(error);
 
-                    db.addProgram(start, stop, channel, title, desc);
-                    start = stop = channel = title = desc = "";
-                }
-            }
+    statusBar()->showMessage(line);
 
-            linecount++;
+    m_epgRefreshReport << line;
+}
 
-            if ( linecount % 100 == 0 ) {
+void MainWindow::on_edtEPGDownload_clicked()
+{
+    if (QMessageBox::Yes == QMessageBox(QMessageBox::Information, "Downloader", "start the download?", QMessageBox::Yes|QMessageBox::No).exec())  {
 
-                statusBar()->showMessage(tr("%1 programs").arg(linecount));
-            }
+        QUrl imageUrl(ui->edtUrlEpg->text());
 
-            QCoreApplication::processEvents();
-    }
+        // parse and import while the download is running, the file is written alongside
+        if (ui->chkEPGImport->isChecked() ) {
 
-    if(xmlReader->hasError()) {
-        QMessageBox::critical(this, "xmlFile.xml Parse Error", xmlReader->errorString(), QMessageBox::Ok);
-        return;
-    }
+            const QString timestamp = QDateTime::currentDateTime().toString(QLatin1String("yyyyMMddhhmmss"));
+            QString filename = m_AppDataPath + "/" + QString::fromLatin1("/epg-%1.xml").arg(timestamp);
 
-    //close reader and flush file
-    xmlReader->clear();
-    xmlFile->close();
+            if ( imageUrl.path().endsWith(".gz") ) {
+                filename += ".gz";
+            } else if ( imageUrl.path().endsWith(".xz") ) {
+                filename += ".xz";
+            }
 
-#ifdef Q_OS_WIN
-    taskbarProgress->setVisible(false);
-#endif
-    m_progress->setVisible(false);
-    m_progressCancel->setVisible(false);
+            this->setImportRunning(true);
 
-    this->fillComboEPGChannels();
+            statusBar()->showMessage(tr("download and import %1...").arg(imageUrl.toString()));
 
-    QMessageBox::information(this, "m3uMan", QString("EPG data import done..."), QMessageBox::Ok);
-}
+            this->emitEpgChannelFilter();
 
-void MainWindow::on_edtEPGDownload_clicked()
-{
-    if (QMessageBox::Yes == QMessageBox(QMessageBox::Information, "Downloader", "start the download?", QMessageBox::Yes|QMessageBox::No).exec())  {
+            emit startEpgDownload(imageUrl.toString(), filename, ui->edtUrlEpgHour->text());
+            return;
+        }
 
-        QUrl imageUrl(ui->edtUrlEpg->text());
         m_pImgCtrl = new FileDownloader(imageUrl, this);
 
         m_pImgCtrl->setData( ui->edtUrlEpgHour->text() );
@@ -2180,7 +1923,7 @@ void MainWindow::displayMovieInfo(int extinf_id, QString moviedata, bool storeda
 
 void MainWindow::progressCancel_clicked()
 {
-    m_ProgressWasCanceled = true;
+    m_importWorker->cancel();
 }
 
 
@@ -2260,7 +2003,7 @@ void MainWindow::on_cmdSetLogo_clicked()
 
 void MainWindow::fillComboEPGChannels()
 {
-    QSqlQuery *select = nullptr;
+    DbCursor select;
     QString title;
     QString id;
 
@@ -2280,8 +2023,6 @@ void MainWindow::fillComboEPGChannels()
         ui->cboEPGChannels->addItem(title);
     }
 
-    delete select;
-
     ui->cboEPGChannels->blockSignals(false);
 }
 
@@ -2702,24 +2443,22 @@ void MainWindow::on_actionImport_logo_links_triggered()
 
 void MainWindow::on_cmdEPG_clicked()
 {
-    QSqlQuery *select;
     QString   start, stop, title, descr;
 
     ui->edtOutput->clear();
 
-    select = db.selectProgramData(ui->cboEPGChannels->currentText());
-    while ( select->next() ) {
+    const QVector<EpgEntry> programs = m_epgCache->rest(ui->cboEPGChannels->currentText(), QDateTime::currentDateTimeUtc().toSecsSinceEpoch());
+
+    foreach (const EpgEntry &program, programs) {
 
-        start = select->value(0).toByteArray().constData();
-        stop = select->value(1).toByteArray().constData();
-        title = select->value(2).toByteArray().constData();
-        descr = select->value(3).toByteArray().constData();
+        start = QDateTime::fromSecsSinceEpoch(program.start).toString("dd hh:mm:ss");
+        stop = QDateTime::fromSecsSinceEpoch(program.stop).toString("dd hh:mm:ss");
+        title = m_epgCache->text(program.title);
+        descr = m_epgCache->text(program.desc);
 
         ui->edtOutput->append( start + " - " + stop + " - <font color=\"lightgreen\">" + title + "</font><br><br>" + descr + "<br><br>");
     }
 
-    delete select;
-
     ui->edtOutput->moveCursor(QTextCursor::Start);
 }
 
@@ -2830,6 +2569,39 @@ void MainWindow::on_edtUrlEpgHour_returnPressed()
     settings.sync();
 }
 
+void MainWindow::on_actionRefresh_all_EPG_sources_triggered()
+{
+    QSettings   settings(m_SettingsFile, QSettings::IniFormat);
+    QStringList sources;
+
+    // EPG1..EPG5 hold url;hour
+    for ( int i = 0; i < ui->cboUrlEpgSource->count(); i++ ) {
+
+        const QString value = settings.value(ui->cboUrlEpgSource->itemText(i)).toString();
+
+        if ( ! value.section(';', 0, 0).trimmed().isEmpty() ) {
+            sources << value;
+        }
+    }
+
+    if ( sources.isEmpty() ) {
+        QMessageBox::information(this, "m3uMan", QString("No EPG source configured..."), QMessageBox::Ok);
+        return;
+    }
+
+    const QString timestamp = QDateTime::currentDateTime().toString(QLatin1String("yyyyMMddhhmmss"));
+
+    m_epgRefreshReport.clear();
+
+    this->setImportRunning(true);
+
+    statusBar()->showMessage(tr("refresh %1 EPG sources...").arg(sources.size()));
+
+    this->emitEpgChannelFilter();
+
+    emit startEpgRefresh(sources, m_AppDataPath + "/" + QString::fromLatin1("/epg-%1-").arg(timestamp) + "%1.xml");
+}
+
 void MainWindow::on_actionMake_backup_on_next_run_triggered()
 {
     QSettings settings(m_SettingsFile, QSettings::IniFormat);
@@ -2883,7 +2655,7 @@ void MainWindow::on_actionRestore_backup_triggered()
 
 void MainWindow::on_actionRestore_INI_file_triggered()
 {
-    QSqlQuery *select ;
+    DbCursor select;
 
     QString saveFile = QFileDialog::getSaveFileName(this, tr("INI Data Save As..."), m_AppDataPath + "/settings_restore.ini", tr("Settings Files (*.ini)"));
 
@@ -2909,8 +2681,6 @@ void MainWindow::on_actionRestore_INI_file_triggered()
         outfile.close();
     }
 
-    delete select;
-
     QMessageBox::information(this, "m3uMan", QString("Restore to <b>" + saveFile + "</b> successful done..." ) ) ;
 }
 
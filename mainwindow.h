@@ -39,6 +39,9 @@
 #include <QPoint>
 #include <QHostInfo>
 #include <QStorageInfo>
+#include <QThread>
+#include <QTimer>
+#include <QHash>
 
 #ifdef Q_OS_WIN
 #include <QWinTaskbarButton>
@@ -58,6 +61,10 @@
 #include <VLCQtWidgets/ControlVideo.h>
 
 #include "dbmanager.h"
+#include "importworker.h"
+#include "m3uexporter.h"
+#include "stationtree.h"
+#include "epgcache.h"
 #include "filedownloader.h"
 #include "EqualizerDialog.h"
 
@@ -91,19 +98,18 @@ private:
     void setCurrentFile(const QString &);
     void getFileData(const QString &);
     void getEPGFileData(const QString &, const QString &);
+    void emitEpgChannelFilter();
     void fillTreeWidget();
     void fillTwPls_Item();
+    void loadActualPrograms(int);
     void fillComboPlaylists();
     void fillComboGroupTitels();
 
-    QStringList splitCommandLine(const QString &);
     void getTMDBdate(const QString &, int, int);
     void getTMDBdataById(int, int);
 
     void displayMovieInfo(int, QString, bool);
 
-    QTreeWidgetItem* addTreeRoot(const QString &, const QString &, const QString &, int);
-    void addTreeChild(QTreeWidgetItem *parent, const QString &, const QString &, const QString &, const QString &, const QString &, const QString &, const QString& logo);
     void get_media_sub_items( const libvlc_media_t& media );
 
     void FindAndColorAllButtons();
@@ -113,6 +119,15 @@ private:
 
     QPixmap changeIconColor(QIcon, QColor);
     void fillComboEPGChannels();
+    void setImportRunning(bool);
+
+signals:
+    void startM3uImport(const QString &);
+    void startM3uDownload(const QString &, const QString &);
+    void startEpgImport(const QString &, const QString &);
+    void startEpgDownload(const QString &, const QString &, const QString &);
+    void startEpgRefresh(const QStringList &, const QString &);
+    void epgChannelFilter(bool, const QStringList &);
 
 private slots:
     void on_edtLoad_clicked();
@@ -165,6 +180,12 @@ private slots:
     void on_cmdMute_clicked();
     void on_cmdImdb_clicked();
     void progressCancel_clicked();
+    void importProgress(int, int, const QString &);
+    void m3uImportFinished(int, int, int, int, int, int, double, bool, bool);
+    void m3uDownloadFailed(const QString &);
+    void refreshActualPrograms();
+    void epgImportFinished(int, int, double, const QString &, bool);
+    void epgSourceFinished(const QString &, int, qint64, const QString &);
     void on_actionload_stylsheet_triggered();
     void on_cmdSetPos_clicked();
     void on_cmdSetLogo_clicked();
@@ -220,6 +241,7 @@ private slots:
     void on_edtUrlEpgHour_returnPressed();
 
     void on_actionMake_backup_on_next_run_triggered();
+    void on_actionRefresh_all_EPG_sources_triggered();
 
     void on_actionWrite_INI_to_database_triggered();
 
@@ -239,7 +261,6 @@ private:
     QStandardPaths  *path;
     QString         m_AppDataPath;
     QString         m_SettingsFile;
-    bool            m_ProgressWasCanceled;
     QTreeWidgetItem *m_ActTreeItem;
 
     QString               m_IconColor;
@@ -263,6 +284,16 @@ private:
     QProgressBar    *m_progress;
     QPushButton     *m_progressCancel;
 
+    QThread         m_importThread;
+    ImportWorker    *m_importWorker;
+
+    EpgCache        *m_epgCache;
+    QStringList     m_epgRefreshReport;
+
+    QHash<QString, QString> m_actualPrograms;
+    QTimer          m_actualProgramsTimer;
+    int             m_actualProgramsPlsId;
+
 #ifdef Q_OS_WIN
     QWinTaskbarButton *taskbarButton;
     QWinTaskbarProgress *taskbarProgress;
@@ -0,0 +1,80 @@
+#include "stationtree.h"
+
+#include <QColor>
+
+StationTree::StationTree(QTreeWidget *tree) :
+    m_tree(tree)
+{
+}
+
+void StationTree::populate(const std::vector<ExtinfRow> &stations)
+{
+    QTreeWidgetItem *item = nullptr;
+    QString          group, lastgroup;
+
+    m_tree->clear();
+    m_tree->setColumnCount(4);
+    m_tree->setHeaderLabels(QStringList() << "Group" << "Station" << "ID" << "Logo");
+
+    m_tree->blockSignals(true);
+
+    for ( const ExtinfRow &station : stations ) {
+
+        group = station.group_title;
+
+        if (group.isEmpty()) {
+            group = " ";
+        }
+
+        if ( group != lastgroup || item == nullptr ) {
+            item = this->addRoot(group, "", station.group_id, station.group_favorite);
+            lastgroup = group;
+        }
+
+        this->addChild(item, station);
+    }
+
+    m_tree->blockSignals(false);
+}
+
+QTreeWidgetItem* StationTree::addRoot(const QString& name, const QString& description, int id, int favorite)
+{
+    QTreeWidgetItem *treeItem = new QTreeWidgetItem(m_tree);
+
+    treeItem->setText(0, name);
+    treeItem->setText(1, description);
+    treeItem->setText(2, QString::number(id));
+
+    if ( favorite == 1 ) {
+         treeItem->setBackground(0, QColor("orange") );
+    }
+
+    return treeItem;
+}
+
+void StationTree::addChild(QTreeWidgetItem *parent, const ExtinfRow &station)
+{
+    QTreeWidgetItem *treeItem = new QTreeWidgetItem();
+
+    treeItem->setText(0, station.tvg_name);
+    treeItem->setText(1, station.tvg_id);
+
+    if ( station.state == 1 ) {
+         treeItem->setBackground(2, QColor("#FFCCCB") ); // light red (active stream )
+    } else if ( station.state == 2 ) {
+         treeItem->setBackground(2, QColor("#90ee90") ); // light green (new stream)
+    }
+
+    treeItem->setText(2, QString::number(station.id));
+    treeItem->setData(Qt::UserRole, 0, station.url);
+
+    treeItem->setText(3, station.tvg_logo);
+
+    treeItem->setStatusTip(0, QObject::tr("double click to add the station to the selected playlist"));
+
+    if ( station.used > 0 ) {
+        treeItem->setBackground(0, QColor("#4CAF50") );
+    }
+
+    parent->addChild(treeItem);
+}
@@ -0,0 +1,28 @@
+#ifndef STATIONTREE_H
+#define STATIONTREE_H
+
+#include <QTreeWidget>
+
+#include <vector>
+
+#include "dbmanager.h"
+
+// Fills the station tree, a root per group with its stations as children.
+// The rows come grouped from DbManager::selectEXTINF. Used by the main
+// window and the benchmark, so both time the same code.
+
+class StationTree
+{
+public:
+    explicit StationTree(QTreeWidget *tree);
+
+    void populate(const std::vector<ExtinfRow> &stations);
+
+private:
+    QTreeWidgetItem *addRoot(const QString &name, const QString &description, int id, int favorite);
+    void addChild(QTreeWidgetItem *parent, const ExtinfRow &station);
+
+    QTreeWidget *m_tree;
+};
+
+#endif // STATIONTREE_H
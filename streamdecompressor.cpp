@@ -0,0 +1,247 @@
+#include "streamdecompressor.h"
+
+#include <QDebug>
+
+#include <cstring>
+
+static const int outputSize = 256 * 1024;
+static const int magicSize = 6;
+
+StreamDecompressor::StreamDecompressor() :
+    m_format(Plain),
+    m_active(false),
+    m_streamEnd(false),
+    m_lzma(LZMA_STREAM_INIT)
+{
+}
+
+StreamDecompressor::~StreamDecompressor()
+{
+    this->end();
+}
+
+StreamDecompressor::Format StreamDecompressor::detect(const char *data, qint64 size)
+{
+    const unsigned char *magic = reinterpret_cast<const unsigned char *>(data);
+
+    if ( size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b ) {
+        return Gzip;
+    }
+
+    if ( size >= 6 && memcmp(magic, "\xfd" "7zXZ\0", 6) == 0 ) {
+        return Xz;
+    }
+
+    return Plain;
+}
+
+bool StreamDecompressor::begin(Format format)
+{
+    this->end();
+
+    m_format = format;
+    m_streamEnd = false;
+    m_error.clear();
+    m_magic.clear();
+
+    if ( format == Gzip ) {
+
+        memset(&m_zstream, 0, sizeof(m_zstream));
+
+        // 15 + 32, the zlib or gzip header is detected by inflate itself
+        if ( inflateInit2(&m_zstream, 15 + 32) != Z_OK ) {
+            m_error = QString("inflateInit2 failed");
+            return false;
+        }
+
+    } else if ( format == Xz ) {
+
+        m_lzma = LZMA_STREAM_INIT;
+
+        if ( lzma_stream_decoder(&m_lzma, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK ) {
+            m_error = QString("lzma_stream_decoder failed");
+            return false;
+        }
+    }
+
+    m_active = true;
+
+    return true;
+}
+
+// picks the format from the held back bytes and feeds them to it
+bool StreamDecompressor::beginDetected(QByteArray &out)
+{
+    const QByteArray magic = m_magic;
+
+    if ( ! this->begin(detect(magic.constData(), magic.size())) ) {
+        return false;
+    }
+
+    return this->decompress(magic.constData(), magic.size(), out);
+}
+
+void StreamDecompressor::end()
+{
+    if ( m_active ) {
+
+        if ( m_format == Gzip ) {
+            inflateEnd(&m_zstream);
+        } else if ( m_format == Xz ) {
+            lzma_end(&m_lzma);
+        }
+    }
+
+    m_active = false;
+}
+
+bool StreamDecompressor::decompress(const char *data, qint64 size, QByteArray &out)
+{
+    if ( ! m_error.isEmpty() ) {
+        return false;
+    }
+
+    if ( m_format == Plain ) {
+        out.append(data, int(size));
+        return true;
+    }
+
+    // a first chunk of a few bytes can't tell xz from plain data yet
+    if ( m_format == Detect ) {
+
+        m_magic.append(data, int(size));
+
+        return m_magic.size() < magicSize || this->beginDetected(out);
+    }
+
+    if ( ! m_active ) {
+        m_error = QString("decompressor not started");
+        return false;
+    }
+
+    if ( m_format == Gzip ) {
+
+        m_zstream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        m_zstream.avail_in = uInt(size);
+
+        for ( ;; ) {
+
+            // a .gz file may hold several members one after the other
+            if ( m_streamEnd ) {
+
+                if ( m_zstream.avail_in == 0 ) {
+                    break;
+                }
+
+                inflateReset(&m_zstream);
+                m_streamEnd = false;
+            }
+
+            const int length = out.size();
+            out.resize(length + outputSize);
+
+            m_zstream.next_out = reinterpret_cast<Bytef *>(out.data() + length);
+            m_zstream.avail_out = outputSize;
+
+            const int ret = inflate(&m_zstream, Z_NO_FLUSH);
+
+            out.resize(length + outputSize - int(m_zstream.avail_out));
+
+            if ( ret == Z_STREAM_END ) {
+                m_streamEnd = true;
+            } else if ( ret == Z_BUF_ERROR ) {
+                break;
+            } else if ( ret != Z_OK ) {
+                m_error = QString("gzip: %1").arg(m_zstream.msg != nullptr ? m_zstream.msg : "inflate failed");
+                return false;
+            } else if ( m_zstream.avail_in == 0 && m_zstream.avail_out != 0 ) {
+                break;
+            }
+        }
+
+    } else {
+
+        m_lzma.next_in = reinterpret_cast<const uint8_t *>(data);
+        m_lzma.avail_in = size_t(size);
+
+        for ( ;; ) {
+
+            const int length = out.size();
+            out.resize(length + outputSize);
+
+            m_lzma.next_out = reinterpret_cast<uint8_t *>(out.data() + length);
+            m_lzma.avail_out = outputSize;
+
+            const lzma_ret ret = lzma_code(&m_lzma, LZMA_RUN);
+
+            out.resize(length + outputSize - int(m_lzma.avail_out));
+
+            if ( ret == LZMA_STREAM_END ) {
+                m_streamEnd = true;
+                break;
+            } else if ( ret == LZMA_BUF_ERROR ) {
+                break;
+            } else if ( ret != LZMA_OK ) {
+                m_error = QString("xz: lzma_code failed (%1)").arg(int(ret));
+                return false;
+            } else if ( m_lzma.avail_in == 0 && m_lzma.avail_out != 0 ) {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool StreamDecompressor::finish(QByteArray &out)
+{
+    if ( ! m_error.isEmpty() ) {
+        return false;
+    }
+
+    // the data ended before the magic was complete
+    if ( m_format == Detect && ! this->beginDetected(out) ) {
+        return false;
+    }
+
+    // LZMA_CONCATENATED only reports the end once it knows there is no more input
+    if ( m_format == Xz && m_active && !m_streamEnd ) {
+
+        lzma_ret ret = LZMA_OK;
+
+        while ( ret == LZMA_OK ) {
+
+            const int length = out.size();
+            out.resize(length + outputSize);
+
+            m_lzma.next_out = reinterpret_cast<uint8_t *>(out.data() + length);
+            m_lzma.avail_out = outputSize;
+
+            ret = lzma_code(&m_lzma, LZMA_FINISH);
+
+            out.resize(length + outputSize - int(m_lzma.avail_out));
+        }
+
+        m_streamEnd = ( ret == LZMA_STREAM_END );
+    }
+
+    this->end();
+
+    if ( m_format != Plain && !m_streamEnd ) {
+        m_error = QString("the compressed data is truncated");
+        qDebug() << "StreamDecompressor" << m_error;
+        return false;
+    }
+
+    return true;
+}
+
+StreamDecompressor::Format StreamDecompressor::format() const
+{
+    return m_format;
+}
+
+QString StreamDecompressor::errorString() const
+{
+    return m_error;
+}
@@ -0,0 +1,46 @@
+#ifndef STREAMDECOMPRESSOR_H
+#define STREAMDECOMPRESSOR_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <zlib.h>
+#include <lzma.h>
+
+// Inflates gzip and xz data chunk by chunk, so a compressed EPG or m3u file
+// never has to be unpacked on disk or as a whole in memory. With Detect the
+// format is taken from the magic bytes, the first bytes are held back until
+// the longest magic is complete or the data ends. Plain data passes through.
+
+class StreamDecompressor
+{
+public:
+    enum Format { Plain, Gzip, Xz, Detect };
+
+    StreamDecompressor();
+    ~StreamDecompressor();
+
+    static Format detect(const char *data, qint64 size);
+
+    bool begin(Format format);
+    bool decompress(const char *data, qint64 size, QByteArray &out);
+    bool finish(QByteArray &out);
+
+    Format format() const;
+    QString errorString() const;
+
+private:
+    void end();
+    bool beginDetected(QByteArray &out);
+
+    Format      m_format;
+    bool        m_active;
+    bool        m_streamEnd;
+    QString     m_error;
+    QByteArray  m_magic;
+
+    z_stream    m_zstream;
+    lzma_stream m_lzma;
+};
+
+#endif // STREAMDECOMPRESSOR_H
@@ -0,0 +1,110 @@
+#include "streamdownloader.h"
+
+#include <QDebug>
+#include <QNetworkRequest>
+
+static const qint64 readBufferSize = 256 * 1024;
+
+StreamDownloader::StreamDownloader(const QUrl &url, const QString &filename, QObject *parent) :
+    QObject(parent),
+    m_WebCtrl(this),
+    m_reply(nullptr),
+    m_url(url),
+    m_file(filename, this),
+    m_bytesReceived(0),
+    m_aborted(false)
+{
+}
+
+StreamDownloader::~StreamDownloader()
+{
+    if ( m_reply != nullptr ) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+    }
+}
+
+void StreamDownloader::start()
+{
+    qDebug() << "StreamDownloader" << m_url.toString() << m_file.fileName();
+
+    if ( ! m_file.fileName().isEmpty() && ! m_file.open(QIODevice::WriteOnly) ) {
+        emit finished(false, tr("Couldn't open %1 for writing").arg(m_file.fileName()));
+        return;
+    }
+
+    QNetworkRequest request(m_url);
+    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+
+    m_reply = m_WebCtrl.get(request);
+    m_reply->setReadBufferSize(readBufferSize);
+
+    connect(m_reply, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    connect(m_reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(downloadProgress(qint64, qint64)));
+    connect(m_reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+}
+
+void StreamDownloader::abort()
+{
+    m_aborted = true;
+
+    if ( m_reply != nullptr ) {
+        m_reply->abort();
+    }
+}
+
+QString StreamDownloader::getFilename() const
+{
+    return m_file.fileName();
+}
+
+qint64 StreamDownloader::bytesReceived() const
+{
+    return m_bytesReceived;
+}
+
+void StreamDownloader::readyRead()
+{
+    const QByteArray data = m_reply->readAll();
+
+    if ( data.isEmpty() ) {
+        return;
+    }
+
+    if ( m_file.isOpen() && m_file.write(data) != data.size() ) {
+        qDebug() << "StreamDownloader" << m_file.fileName() << m_file.errorString();
+    }
+
+    m_bytesReceived += data.size();
+
+    emit received(data);
+}
+
+void StreamDownloader::downloadProgress(qint64 bytesRead, qint64 totalBytes)
+{
+    emit progress(bytesRead, totalBytes);
+}
+
+void StreamDownloader::replyFinished()
+{
+    QString error;
+
+    // pick up what came in together with the end of the reply
+    if ( m_reply->error() == QNetworkReply::NoError ) {
+        this->readyRead();
+    }
+
+    if ( m_aborted ) {
+        error = tr("download canceled");
+    } else if ( m_reply->error() != QNetworkReply::NoError ) {
+        error = m_reply->errorString();
+    }
+
+    m_file.close();
+
+    m_reply->deleteLater();
+    m_reply = nullptr;
+
+    emit finished(error.isEmpty(), error);
+}
@@ -0,0 +1,46 @@
+#ifndef STREAMDOWNLOADER_H
+#define STREAMDOWNLOADER_H
+
+#include <QObject>
+#include <QFile>
+#include <QUrl>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+// Downloads a url chunk by chunk as the bytes arrive and writes them to a
+// file at the same time. The read buffer of the reply is limited, so a slow
+// consumer of received() throttles the download instead of filling memory.
+
+class StreamDownloader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StreamDownloader(const QUrl &url, const QString &filename, QObject *parent = nullptr);
+    virtual ~StreamDownloader();
+
+    void start();
+    void abort();
+
+    QString getFilename() const;
+    qint64  bytesReceived() const;
+
+signals:
+    void received(const QByteArray &data);
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
+    void finished(bool success, const QString &error);
+
+private slots:
+    void readyRead();
+    void downloadProgress(qint64, qint64);
+    void replyFinished();
+
+private:
+    QNetworkAccessManager m_WebCtrl;
+    QNetworkReply*        m_reply;
+    QUrl                  m_url;
+    QFile                 m_file;
+    qint64                m_bytesReceived;
+    bool                  m_aborted;
+};
+
+#endif // STREAMDOWNLOADER_H